@@ -0,0 +1,142 @@
+// bench_startup.c
+
+/*
+Concepts:
+    Startup benchmark: launches the emulator over and over and reports how long each
+    launch took to execute its first CHIP-8 instruction and to produce its first frame.
+    Usage:
+        chip8-bench-startup [-n RUNS] <chip8 binary> [args...]
+    e.g. chip8-bench-startup -n 500 ./chip8 --headless --fast --frames 1 builtin:PONG
+    How is it measured? CLOCK_MONOTONIC is shared by all processes, so the time taken just
+    before fork() is handed to the child in CHIP8_STARTUP_T0. The emulator reports both
+    milestones relative to it on stderr, so exec, dynamic linking and all init are counted.
+    Reported: min, median and p95 of each milestone plus whole-process wall time.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STARTUP_MAX_RUNS 100000
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *label, uint64_t *v, int n) {
+    qsort(v, (size_t)n, sizeof(*v), cmp_u64);
+    int p95 = (int)((n - 1) * 0.95);
+    printf("%-20s min %8.1f us   median %8.1f us   p95 %8.1f us\n",
+           label, v[0] / 1e3, v[n / 2] / 1e3, v[p95] / 1e3);
+}
+
+// One launch; returns 0 and fills the three timings on success
+static int run_once(char **cmd, uint64_t *first_instruction, uint64_t *first_frame, uint64_t *total) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return -1;
+    }
+
+    uint64_t t0 = now_ns();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        char env[32];
+        snprintf(env, sizeof(env), "%llu", (unsigned long long)t0);
+        setenv("CHIP8_STARTUP_T0", env, 1);
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) dup2(null, STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execv(cmd[0], cmd);
+        _exit(127);
+    }
+    close(fds[1]);
+
+    // The report line is printed after the first frame, so it is near the start of stderr;
+    // anything past the buffer is drained and dropped
+    char buf[4096], drain[512];
+    size_t len = 0;
+    ssize_t r;
+    for (;;) {
+        if (len < sizeof(buf) - 1) r = read(fds[0], buf + len, sizeof(buf) - 1 - len);
+        else r = read(fds[0], drain, sizeof(drain));
+        if (r <= 0) break;
+        if (len < sizeof(buf) - 1) len += (size_t)r;
+    }
+    buf[len] = '\0';
+    close(fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    *total = now_ns() - t0;
+
+    const char *line = strstr(buf, "startup:");
+    unsigned long long fi, ff;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !line ||
+        sscanf(line, "startup: first_instruction_ns=%llu first_frame_ns=%llu", &fi, &ff) != 2) {
+        fprintf(stderr, "Run failed (status %d): %s", status, buf);
+        return -1;
+    }
+    *first_instruction = fi;
+    *first_frame = ff;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int runs = 200;
+    int i = 1;
+    if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+        runs = atoi(argv[i + 1]);
+        i += 2;
+    }
+    if (i >= argc || runs < 1 || runs > STARTUP_MAX_RUNS) {
+        fprintf(stderr, "Usage: %s [-n RUNS] <chip8 binary> [args...]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t *fi = malloc(sizeof(uint64_t) * (size_t)runs);
+    uint64_t *ff = malloc(sizeof(uint64_t) * (size_t)runs);
+    uint64_t *total = malloc(sizeof(uint64_t) * (size_t)runs);
+    if (!fi || !ff || !total) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (int r = 0; r < runs; ++r) {
+        if (run_once(&argv[i], &fi[r], &ff[r], &total[r]) != 0) return 1;
+    }
+
+    printf("%d runs:", runs);
+    for (int k = i; k < argc; ++k) printf(" %s", argv[k]);
+    printf("\n");
+    report("first instruction", fi, runs);
+    report("first frame", ff, runs);
+    report("process total", total, runs);
+
+    free(fi);
+    free(ff);
+    free(total);
+    return 0;
+}
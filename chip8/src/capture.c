@@ -0,0 +1,348 @@
+// capture.c
+
+/*
+Concepts:
+    Implementation of capture.h for the CHIP-8 emulator.
+    How does the queue stay lock-free? Only the emulation thread moves head and only the encoder
+    moves tail; each publishes its index with a release store and reads the other's with an
+    acquire load. A full ring means the frame is dropped, never waited on.
+    How does an idle encoder sleep without the producer taking a lock? The encoder raises
+    sleeping under its mutex, then re-checks head before waiting on the condvar; the producer
+    publishes head and only then looks at sleeping, locking and signalling just when it is set.
+    Both pairs are sequentially consistent, so at least one side sees the other's store and a
+    wakeup cannot be lost.
+    How do drops keep the timeline true? The next queued frame carries the number of frames
+    dropped before it; the encoder writes a skip marker (.c8v) or repeats the last frame
+    (.y4m / .rgb) for them, and silence in the WAV, so every format stays one entry per frame.
+    What does a .c8v file look like?
+        header: "C8V1", width, height, fps (one byte each), one reserved byte
+        per frame, one tag byte:
+            0x00  same as the previous frame
+            0x01  keyframe: 256 raw bytes follow
+            0x02  delta: XOR against the previous frame, run-length coded as tokens
+                  0x00-0x7F  skip (n + 1) unchanged bytes
+                  0x80-0xFF  (n & 0x7F) + 1 literal XOR bytes follow
+            0x03  dropped: u16 LE count follows; that many frames were not captured
+                  (show the previous frame for them)
+        Bit 7 of the tag (0x80) is set when the beeper was on during the frame.
+    Why a sine for the WAV? It matches what sound.c plays through SDL.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "capture.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define C8V_SAME 0x00
+#define C8V_KEY 0x01
+#define C8V_DELTA 0x02
+#define C8V_DROPPED 0x03
+#define C8V_BEEP 0x80
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void wav_write_header(FILE *f, uint32_t samples) {
+    uint8_t h[44];
+    uint32_t data_bytes = samples * 2;
+    memcpy(h, "RIFF", 4);
+    put_le32(h + 4, 36 + data_bytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le32(h + 16, 16);
+    put_le16(h + 20, 1);                          // PCM
+    put_le16(h + 22, 1);                          // mono
+    put_le32(h + 24, CAPTURE_SAMPLE_RATE);
+    put_le32(h + 28, CAPTURE_SAMPLE_RATE * 2);    // byte rate
+    put_le16(h + 32, 2);                          // block align
+    put_le16(h + 34, 16);                         // bits per sample
+    memcpy(h + 36, "data", 4);
+    put_le32(h + 40, data_bytes);
+    fwrite(h, 1, sizeof(h), f);
+}
+
+static void encode_audio(Capture *c, int beep) {
+    const int samples = CAPTURE_SAMPLE_RATE / CAPTURE_FPS;
+    uint8_t pcm[(CAPTURE_SAMPLE_RATE / CAPTURE_FPS) * 2];
+    for (int i = 0; i < samples; ++i) {
+        int16_t s = 0;
+        if (beep) {
+            s = (int16_t)(0.1f * sinf(c->phase * 2.0f * (float)M_PI) * 32767.0f);
+            c->phase += 440.0f / CAPTURE_SAMPLE_RATE;
+            if (c->phase >= 1.0f) c->phase -= 1.0f;
+        }
+        put_le16(&pcm[i * 2], (uint16_t)s);
+    }
+    fwrite(pcm, 1, sizeof(pcm), c->audio);
+    c->audio_samples += (uint32_t)samples;
+}
+
+static void encode_c8v(Capture *c, const CaptureFrame *f) {
+    uint8_t beep = f->beep ? C8V_BEEP : 0;
+
+    if (c->encoded == 0) {
+        fputc(C8V_KEY | beep, c->video);
+        fwrite(f->bits, 1, CAPTURE_FRAME_BYTES, c->video);
+        return;
+    }
+
+    uint8_t diff[CAPTURE_FRAME_BYTES];
+    int changed = 0;
+    for (int i = 0; i < CAPTURE_FRAME_BYTES; ++i) {
+        diff[i] = f->bits[i] ^ c->prev[i];
+        changed |= diff[i];
+    }
+    if (!changed) {
+        fputc(C8V_SAME | beep, c->video);
+        return;
+    }
+
+    // Worst case is one literal token per 128 bytes, so this never exceeds a keyframe by much
+    uint8_t out[CAPTURE_FRAME_BYTES + CAPTURE_FRAME_BYTES / 128 + 1];
+    size_t len = 0;
+    int i = 0;
+    while (i < CAPTURE_FRAME_BYTES) {
+        int run = 0;
+        while (i + run < CAPTURE_FRAME_BYTES && diff[i + run] == 0 && run < 128) run++;
+        if (run > 0) {
+            out[len++] = (uint8_t)(run - 1);
+            i += run;
+            continue;
+        }
+        int lit = 0;
+        while (i + lit < CAPTURE_FRAME_BYTES && lit < 128 &&
+               (diff[i + lit] != 0 || (i + lit + 1 < CAPTURE_FRAME_BYTES && diff[i + lit + 1] != 0))) lit++;
+        out[len++] = (uint8_t)(0x80 | (lit - 1));
+        memcpy(&out[len], &diff[i], (size_t)lit);
+        len += (size_t)lit;
+        i += lit;
+    }
+
+    if (len >= CAPTURE_FRAME_BYTES) {
+        fputc(C8V_KEY | beep, c->video);
+        fwrite(f->bits, 1, CAPTURE_FRAME_BYTES, c->video);
+    } else {
+        fputc(C8V_DELTA | beep, c->video);
+        fwrite(out, 1, len, c->video);
+    }
+}
+
+// Writes the frame held in c->pixels
+static void write_filtered(Capture *c) {
+    const int width = filter_width(&c->filter);
+    const int height = filter_height(&c->filter);
+
+    if (c->format == CAPTURE_Y4M) fputs("FRAME\n", c->video);
+
+    for (int y = 0; y < height; ++y) {
+        const uint32_t *src = &c->pixels[(size_t)y * (size_t)width];
+        uint8_t *dst = c->line;
+        for (int x = 0; x < width; ++x) {
+            uint32_t p = src[x]; // 0xRRGGBBAA
+            uint32_t r = p >> 24, g = (p >> 16) & 0xFF, b = (p >> 8) & 0xFF;
+            if (c->format == CAPTURE_RGB) {
+                *dst++ = (uint8_t)r;
+                *dst++ = (uint8_t)g;
+                *dst++ = (uint8_t)b;
+            } else {
+                *dst++ = (uint8_t)((77 * r + 150 * g + 29 * b) >> 8);
+            }
+        }
+        fwrite(c->line, 1, (size_t)(dst - c->line), c->video);
+    }
+}
+
+static void encode_filtered(Capture *c, const CaptureFrame *f) {
+    uint8_t gfx[DISPLAY_SIZE];
+    for (int i = 0; i < DISPLAY_SIZE; ++i) gfx[i] = (f->bits[i >> 3] >> (7 - (i & 7))) & 1;
+    filter_apply(&c->filter, gfx, c->pixels, filter_width(&c->filter));
+    write_filtered(c);
+}
+
+// Fill in frames that were dropped at the ring: they repeat the last frame, without sound
+static void encode_dropped(Capture *c, uint32_t count) {
+    if (count == 0) return;
+    if (c->video && c->format == CAPTURE_C8V) {
+        for (uint32_t left = count; left > 0;) {
+            uint16_t n = left > 0xFFFF ? 0xFFFF : (uint16_t)left;
+            uint8_t rec[3] = { C8V_DROPPED };
+            put_le16(rec + 1, n);
+            fwrite(rec, 1, sizeof(rec), c->video);
+            left -= n;
+        }
+    } else if (c->video && c->encoded > 0) {
+        for (uint32_t i = 0; i < count; ++i) write_filtered(c);
+    }
+    if (c->audio) {
+        for (uint32_t i = 0; i < count; ++i) encode_audio(c, 0);
+    }
+}
+
+static void *capture_thread(void *arg) {
+    Capture *c = arg;
+    for (;;) {
+        uint32_t tail = c->tail;
+        uint32_t head = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+        if (tail == head) {
+            if (__atomic_load_n(&c->stop, __ATOMIC_ACQUIRE)) {
+                encode_dropped(c, c->skipped); // drops after the last queued frame
+                break;
+            }
+            pthread_mutex_lock(&c->lock);
+            __atomic_store_n(&c->sleeping, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&c->head, __ATOMIC_SEQ_CST) == tail &&
+                !__atomic_load_n(&c->stop, __ATOMIC_SEQ_CST)) {
+                pthread_cond_wait(&c->wake, &c->lock);
+            }
+            __atomic_store_n(&c->sleeping, 0, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&c->lock);
+            continue;
+        }
+
+        const CaptureFrame *f = &c->ring[tail & (CAPTURE_QUEUE_LEN - 1)];
+        encode_dropped(c, f->skipped);
+        if (c->video) {
+            if (c->format == CAPTURE_C8V) encode_c8v(c, f);
+            else encode_filtered(c, f);
+        }
+        if (c->audio) encode_audio(c, f->beep);
+        memcpy(c->prev, f->bits, CAPTURE_FRAME_BYTES);
+        c->encoded++;
+
+        __atomic_store_n(&c->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static CaptureFormat capture_format_for(const char *path) {
+    const char *ext = strrchr(path, '.');
+    if (ext && strcmp(ext, ".y4m") == 0) return CAPTURE_Y4M;
+    if (ext && strcmp(ext, ".rgb") == 0) return CAPTURE_RGB;
+    return CAPTURE_C8V;
+}
+
+Capture* capture_open(const char *video_path, const char *wav_path, const FilterConfig *cfg) {
+    Capture *c = calloc(1, sizeof(Capture));
+    if (!c) return NULL;
+    filter_init(&c->filter, cfg);
+
+    if (video_path) {
+        c->format = capture_format_for(video_path);
+        c->video = fopen(video_path, "wb");
+        if (!c->video) {
+            perror("fopen capture");
+            free(c);
+            return NULL;
+        }
+        if (c->format == CAPTURE_C8V) {
+            const uint8_t header[8] = { 'C', '8', 'V', '1', DISPLAY_WIDTH, DISPLAY_HEIGHT, CAPTURE_FPS, 0 };
+            fwrite(header, 1, sizeof(header), c->video);
+        } else {
+            int width = filter_width(&c->filter), height = filter_height(&c->filter);
+            if (c->format == CAPTURE_Y4M) {
+                fprintf(c->video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 Cmono XCOLORRANGE=FULL\n",
+                        width, height, CAPTURE_FPS);
+            }
+            c->pixels = malloc((size_t)width * (size_t)height * sizeof(uint32_t));
+            c->line = malloc((size_t)width * 3);
+            if (!c->pixels || !c->line) {
+                fclose(c->video);
+                free(c->pixels);
+                free(c->line);
+                free(c);
+                return NULL;
+            }
+        }
+    }
+
+    if (wav_path) {
+        c->audio = fopen(wav_path, "wb");
+        if (!c->audio) {
+            perror("fopen capture wav");
+            if (c->video) fclose(c->video);
+            free(c->pixels);
+            free(c->line);
+            free(c);
+            return NULL;
+        }
+        wav_write_header(c->audio, 0); // sizes patched in capture_close
+    }
+
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->wake, NULL);
+    if (pthread_create(&c->thread, NULL, capture_thread, c) != 0) {
+        fprintf(stderr, "Failed to start capture thread\n");
+        pthread_mutex_destroy(&c->lock);
+        pthread_cond_destroy(&c->wake);
+        if (c->video) fclose(c->video);
+        if (c->audio) fclose(c->audio);
+        free(c->pixels);
+        free(c->line);
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+void capture_push(Capture *c, const uint8_t *gfx, int beep) {
+    uint32_t head = c->head;
+    if (head - __atomic_load_n(&c->tail, __ATOMIC_ACQUIRE) >= CAPTURE_QUEUE_LEN) {
+        c->dropped++;
+        c->skipped++;
+        return;
+    }
+
+    CaptureFrame *f = &c->ring[head & (CAPTURE_QUEUE_LEN - 1)];
+    for (int i = 0; i < CAPTURE_FRAME_BYTES; ++i) {
+        const uint8_t *p = &gfx[i * 8];
+        f->bits[i] = (uint8_t)((p[0] << 7) | (p[1] << 6) | (p[2] << 5) | (p[3] << 4) |
+                               (p[4] << 3) | (p[5] << 2) | (p[6] << 1) | p[7]);
+    }
+    f->beep = beep ? 1 : 0;
+    f->skipped = c->skipped;
+    c->skipped = 0;
+
+    __atomic_store_n(&c->head, head + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&c->sleeping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&c->lock);
+        pthread_cond_signal(&c->wake);
+        pthread_mutex_unlock(&c->lock);
+    }
+}
+
+void capture_close(Capture *c) {
+    if (!c) return;
+    pthread_mutex_lock(&c->lock);
+    __atomic_store_n(&c->stop, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&c->wake);
+    pthread_mutex_unlock(&c->lock);
+    pthread_join(c->thread, NULL);
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->wake);
+
+    if (c->video) fclose(c->video);
+    if (c->audio) {
+        fseek(c->audio, 0, SEEK_SET);
+        wav_write_header(c->audio, c->audio_samples);
+        fclose(c->audio);
+    }
+    if (c->dropped) {
+        fprintf(stderr, "Capture: %llu frame(s) encoded, %llu dropped (recorded as repeats)\n",
+                (unsigned long long)c->encoded, (unsigned long long)c->dropped);
+    }
+    free(c->pixels);
+    free(c->line);
+    free(c);
+}
@@ -0,0 +1,76 @@
+// capture.h
+
+/*
+Concepts:
+    Lossless gameplay recording that never blocks the emulation thread.
+    The runner pushes one packed 1-bit frame per 60 Hz frame into a single-producer /
+    single-consumer ring; if the encoder falls behind the frame is dropped and counted, and
+    recorded as a repeat of the previous frame so the recording keeps real time. This holds for
+    --fast runs too: the emulation thread never waits on the encoder.
+    A background thread drains the ring and encodes, chosen by the output file extension:
+        .c8v   compact delta format for 1-bit frames (see capture.c)
+        .y4m   YUV4MPEG2 mono video (luma of the palette colors), playable by ffmpeg/mpv
+        .rgb   raw RGB24 frames
+    The .y4m and .rgb outputs go through the same filter stage as the window (filter.h), so
+    palette, integer scale, phosphor and scanlines apply to them too.
+    The beeper can be recorded alongside as a 44.1 kHz mono WAV, one frame of audio per frame.
+*/
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "chip8.h"
+#include "filter.h"
+
+#define CAPTURE_QUEUE_LEN 256 // power of two
+#define CAPTURE_FRAME_BYTES (DISPLAY_SIZE / 8)
+#define CAPTURE_SAMPLE_RATE 44100
+#define CAPTURE_FPS 60
+
+typedef enum {
+    CAPTURE_C8V,
+    CAPTURE_Y4M,
+    CAPTURE_RGB
+} CaptureFormat;
+
+typedef struct {
+    uint8_t bits[CAPTURE_FRAME_BYTES]; // row-major, MSB = leftmost pixel
+    uint8_t beep;
+    uint32_t skipped;                  // frames dropped just before this one
+} CaptureFrame;
+
+typedef struct {
+    CaptureFrame ring[CAPTURE_QUEUE_LEN];
+    uint32_t head;                // next slot to fill, written by the emulation thread
+    uint32_t tail;                // next slot to encode, written by the encoder thread
+    int stop;
+    int sleeping;                 // encoder is parked on wake (or about to be)
+    pthread_mutex_t lock;         // guards the encoder's sleep, never taken on a normal push
+    pthread_cond_t wake;
+
+    pthread_t thread;
+    CaptureFormat format;
+    FILE *video;
+    FILE *audio;
+
+    // Encoder state (encoder thread only)
+    uint8_t prev[CAPTURE_FRAME_BYTES];
+    uint64_t encoded;
+    uint32_t audio_samples;
+    float phase;
+    Filter filter;                // .y4m / .rgb only
+    uint32_t *pixels;             // filtered frame
+    uint8_t *line;                // one output row in file format
+
+    uint64_t dropped;             // frames dropped because the ring was full
+    uint32_t skipped;             // drops not yet attached to a queued frame
+} Capture;
+
+Capture* capture_open(const char *video_path, const char *wav_path, const FilterConfig *cfg);
+void capture_push(Capture *c, const uint8_t *gfx, int beep);
+void capture_close(Capture *c);
+
+#endif
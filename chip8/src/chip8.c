@@ -5,13 +5,17 @@ Concepts:
     Implementation of chip8.h functions for CHIP-8 emulator.
     Core initialization, ROM loading, input handling, display management, and emulation cycle.
     How is the CHIP-8 system initialized? By setting up memory, CPU, display, keys, and loading the fontset.
-    How does ROM loading work? By reading a program file into the emulator's memory.
+    How does ROM loading work? By reading a program file into the emulator's memory, or, for a
+    "builtin:NAME" ROM, copying it out of the pack linked into the binary (rompack.h).
     How are keys managed? By setting or clearing their state in the keys array.
     How is the display cleared? By zeroing out the display buffer and setting the draw flag.
     What happens during an emulation cycle? Fetching, decoding, and executing an opcode.
+    What is a snapshot? A plain copy of the whole Chip8 struct. Everything the machine needs,
+    including the RND generator, lives in the struct, so restoring a copy is an exact rollback.
 */
 
 #include "chip8.h"
+#include "rompack.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -46,6 +50,7 @@ void chip8_init(Chip8 *c) {
     memset(c->gfx, 0, sizeof(c->gfx));
     memset(c->keys, 0, sizeof(c->keys));
     c->draw_flag = 0;
+    c->rng = 0x2545F491u;
 
     /* Load fontset at 0x50 (classic) */
     const size_t fontaddr = 0x50;
@@ -55,6 +60,18 @@ void chip8_init(Chip8 *c) {
 }
 
 void chip8_load_rom(Chip8 *c, const char *filename) {
+    // "builtin:NAME" loads from the ROM pack linked into the binary
+    size_t prefix = strlen(ROMPACK_PREFIX);
+    if (strncmp(filename, ROMPACK_PREFIX, prefix) == 0) {
+        const RomPackEntry *rom = rompack_find(filename + prefix);
+        if (!rom) {
+            fprintf(stderr, "No built-in ROM '%s'. Available:\n", filename + prefix);
+            rompack_list(stderr);
+            exit(1);
+        }
+        memory_load_rom_data(&c->memory, rom->data, rom->size);
+        return;
+    }
     memory_load_rom(&c->memory, filename);
 }
 
@@ -62,6 +79,31 @@ void chip8_set_key(Chip8 *c, uint8_t key, uint8_t pressed) {
     if (key < 16) c->keys[key] = pressed ? 1 : 0;
 }
 
+void chip8_run_frame(Chip8 *c, int cycles) {
+    for (int i = 0; i < cycles; ++i) {
+        chip8_emulate_cycle(c);
+    }
+}
+
+void chip8_tick_timers(Chip8 *c) {
+    if (c->cpu.delay_timer > 0) c->cpu.delay_timer--;
+    if (c->cpu.sound_timer > 0) c->cpu.sound_timer--;
+}
+
+void chip8_snapshot(const Chip8 *c, Chip8 *out) {
+    memcpy(out, c, sizeof(*out));
+}
+
+int chip8_waiting_for_key(const Chip8 *c) {
+    // Blocked on FX0A: PC stays on the instruction until some key is down
+    if (c->cpu.pc + 1 >= MEMORY_SIZE) return 0;
+    if ((c->memory.data[c->cpu.pc] & 0xF0) != 0xF0 || c->memory.data[c->cpu.pc + 1] != 0x0A) return 0;
+    for (int i = 0; i < 16; ++i) {
+        if (c->keys[i]) return 0;
+    }
+    return 1;
+}
+
 void chip8_clear_display(Chip8 *c) {
     memset(c->gfx, 0, sizeof(c->gfx));
     c->draw_flag = 1;
@@ -220,7 +262,11 @@ void chip8_emulate_cycle(Chip8 *c) {
             break;
 
         case 0xC000: { // RND Vx, byte
-            uint8_t rnd = (uint8_t)(rand() & 0xFF);
+            // xorshift32; state is kept in the struct so snapshots replay identically
+            c->rng ^= c->rng << 13;
+            c->rng ^= c->rng >> 17;
+            c->rng ^= c->rng << 5;
+            uint8_t rnd = (uint8_t)(c->rng & 0xFF);
             c->cpu.V[x] = rnd & nn;
             c->cpu.pc += 2;
             break;
@@ -17,11 +17,16 @@ typedef struct {
     uint8_t gfx[DISPLAY_SIZE]; // 0/1 pixels
     uint8_t keys[16];          // hex keypad state
     uint8_t draw_flag;         // set when display changed
+    uint32_t rng;              // xorshift state for RND, part of the snapshot
 } Chip8;
 
 void chip8_init(Chip8 *c);
 void chip8_load_rom(Chip8 *c, const char *filename);
 void chip8_emulate_cycle(Chip8 *c);
+void chip8_run_frame(Chip8 *c, int cycles);
+void chip8_tick_timers(Chip8 *c);
+void chip8_snapshot(const Chip8 *c, Chip8 *out);
+int chip8_waiting_for_key(const Chip8 *c);
 void chip8_set_key(Chip8 *c, uint8_t key, uint8_t pressed);
 void chip8_clear_display(Chip8 *c);
 void chip8_draw_display(const Chip8 *c);
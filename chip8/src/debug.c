@@ -0,0 +1,627 @@
+// debug.c
+
+/*
+Concepts:
+    Implementation of debug.h for the CHIP-8 emulator.
+    How does a stop work? Breakpoints stop before the instruction at PC runs; watchpoints let
+    the accessing instruction finish and then stop, like hardware watchpoints in GDB.
+    Resuming from a breakpoint skips the check once so "continue" makes progress.
+    How is the protocol framed? GDB packets are "$<data>#<2 hex digit checksum>", acknowledged
+    with '+'. A raw 0x03 byte from the client means "interrupt".
+    Extra query: "qchip8.stack" returns SP and the live return addresses, innermost first.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "debug.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define REG_I 16
+#define REG_PC 17
+#define REG_SP 18
+#define REG_DT 19
+#define REG_ST 20
+#define REG_STACK 21
+
+typedef struct {
+    uint32_t reg_read;   // bits 0-15 = V0..VF, bit 16 = I
+    uint32_t reg_write;
+    uint16_t mem_addr;
+    uint16_t mem_len;
+    uint8_t mem_write;   // memory range is written (else read)
+} Access;
+
+/* ---- access decoding ---- */
+
+#define VBIT(n) (1u << (n))
+#define IBIT (1u << REG_I)
+
+static void decode_access(const Chip8 *c, uint16_t op, Access *a) {
+    uint8_t x = (op >> 8) & 0xF, y = (op >> 4) & 0xF, n = op & 0xF;
+    uint32_t vx_to_v0 = (uint32_t)((2u << x) - 1); // V0..Vx
+    memset(a, 0, sizeof(*a));
+
+    switch (op & 0xF000) {
+        case 0x3000: case 0x4000: a->reg_read = VBIT(x); break;
+        case 0x5000: case 0x9000: a->reg_read = VBIT(x) | VBIT(y); break;
+        case 0x6000: case 0xC000: a->reg_write = VBIT(x); break;
+        case 0x7000: a->reg_read = a->reg_write = VBIT(x); break;
+        case 0x8000:
+            switch (n) {
+                case 0x0: a->reg_read = VBIT(y); a->reg_write = VBIT(x); break;
+                case 0x1: case 0x2: case 0x3:
+                    a->reg_read = VBIT(x) | VBIT(y); a->reg_write = VBIT(x); break;
+                case 0x4: case 0x5: case 0x7:
+                    a->reg_read = VBIT(x) | VBIT(y); a->reg_write = VBIT(x) | VBIT(0xF); break;
+                case 0x6: case 0xE:
+                    a->reg_read = VBIT(x); a->reg_write = VBIT(x) | VBIT(0xF); break;
+                default: break;
+            }
+            break;
+        case 0xA000: a->reg_write = IBIT; break;
+        case 0xB000: a->reg_read = VBIT(0); break;
+        case 0xD000:
+            a->reg_read = VBIT(x) | VBIT(y) | IBIT;
+            a->reg_write = VBIT(0xF);
+            a->mem_addr = c->cpu.I;
+            a->mem_len = n;
+            break;
+        case 0xE000: a->reg_read = VBIT(x); break;
+        case 0xF000:
+            switch (op & 0xFF) {
+                case 0x07: case 0x0A: a->reg_write = VBIT(x); break;
+                case 0x15: case 0x18: a->reg_read = VBIT(x); break;
+                case 0x1E: a->reg_read = VBIT(x) | IBIT; a->reg_write = IBIT; break;
+                case 0x29: a->reg_read = VBIT(x); a->reg_write = IBIT; break;
+                case 0x33:
+                    a->reg_read = VBIT(x) | IBIT;
+                    a->mem_addr = c->cpu.I; a->mem_len = 3; a->mem_write = 1;
+                    break;
+                case 0x55:
+                    a->reg_read = vx_to_v0 | IBIT;
+                    a->mem_addr = c->cpu.I; a->mem_len = (uint16_t)(x + 1); a->mem_write = 1;
+                    break;
+                case 0x65:
+                    a->reg_read = IBIT; a->reg_write = vx_to_v0;
+                    a->mem_addr = c->cpu.I; a->mem_len = (uint16_t)(x + 1);
+                    break;
+                default: break;
+            }
+            break;
+        default: break;
+    }
+}
+
+static int granule_armed(const uint8_t *bitmap, uint32_t addr, uint32_t len) {
+    if (addr >= MEMORY_SIZE) return 0;
+    uint32_t last = addr + len - 1;
+    if (last >= MEMORY_SIZE) last = MEMORY_SIZE - 1;
+    for (uint32_t g = addr >> DEBUG_GRANULE_SHIFT; g <= (last >> DEBUG_GRANULE_SHIFT); ++g) {
+        if (bitmap[g >> 3] & (1u << (g & 7))) return 1;
+    }
+    return 0;
+}
+
+static void rebuild_watch_maps(Debugger *d) {
+    memset(d->read_granules, 0, sizeof(d->read_granules));
+    memset(d->write_granules, 0, sizeof(d->write_granules));
+    d->reg_read_mask = d->reg_write_mask = 0;
+
+    for (int i = 0; i < d->watch_count; ++i) {
+        const Watchpoint *w = &d->watch[i];
+        int reads = w->kind != WATCH_WRITE, writes = w->kind != WATCH_READ;
+        if (w->addr >= DEBUG_REG_BASE) {
+            uint32_t bit = 1u << (w->addr - DEBUG_REG_BASE);
+            if (reads) d->reg_read_mask |= bit;
+            if (writes) d->reg_write_mask |= bit;
+            continue;
+        }
+        uint32_t last = w->addr + w->len - 1;
+        if (last >= MEMORY_SIZE) last = MEMORY_SIZE - 1;
+        for (uint32_t g = w->addr >> DEBUG_GRANULE_SHIFT; g <= (last >> DEBUG_GRANULE_SHIFT); ++g) {
+            if (reads) d->read_granules[g >> 3] |= (uint8_t)(1u << (g & 7));
+            if (writes) d->write_granules[g >> 3] |= (uint8_t)(1u << (g & 7));
+        }
+    }
+}
+
+// Find the watchpoint an access triggers; returns its index or -1
+static int watch_hit(const Debugger *d, const Access *a) {
+    uint32_t regs_r = a->reg_read & d->reg_read_mask;
+    uint32_t regs_w = a->reg_write & d->reg_write_mask;
+    int mem = a->mem_len &&
+              granule_armed(a->mem_write ? d->write_granules : d->read_granules, a->mem_addr, a->mem_len);
+    if (!regs_r && !regs_w && !mem) return -1;
+
+    for (int i = 0; i < d->watch_count; ++i) {
+        const Watchpoint *w = &d->watch[i];
+        int reads = w->kind != WATCH_WRITE, writes = w->kind != WATCH_READ;
+        if (w->addr >= DEBUG_REG_BASE) {
+            uint32_t bit = 1u << (w->addr - DEBUG_REG_BASE);
+            if ((reads && (regs_r & bit)) || (writes && (regs_w & bit))) return i;
+        } else if (mem && (a->mem_write ? writes : reads) &&
+                   w->addr < (uint32_t)a->mem_addr + a->mem_len && a->mem_addr < w->addr + w->len) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* ---- packet I/O ---- */
+
+static void send_raw(Debugger *d, const char *p, size_t len) {
+    while (len > 0 && d->client_fd >= 0) {
+        ssize_t w = write(d->client_fd, p, len);
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = { d->client_fd, POLLOUT, 0 };
+            poll(&pfd, 1, 100);
+            continue;
+        }
+        if (w <= 0) return;
+        p += w;
+        len -= (size_t)w;
+    }
+}
+
+static void send_packet(Debugger *d, const char *data) {
+    static const char hex[] = "0123456789abcdef";
+    char buf[DEBUG_PACKET_MAX + 4];
+    size_t len = strlen(data);
+    if (len > DEBUG_PACKET_MAX - 4) len = DEBUG_PACKET_MAX - 4;
+
+    uint8_t sum = 0;
+    buf[0] = '$';
+    for (size_t i = 0; i < len; ++i) {
+        buf[1 + i] = data[i];
+        sum = (uint8_t)(sum + (uint8_t)data[i]);
+    }
+    buf[1 + len] = '#';
+    buf[2 + len] = hex[sum >> 4];
+    buf[3 + len] = hex[sum & 0xF];
+    send_raw(d, buf, len + 4);
+}
+
+static void stop(Debugger *d, const char *reply) {
+    d->halted = 1;
+    d->step = 0;
+    send_packet(d, reply);
+}
+
+static int hex_val(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+// Saturates at UINT32_MAX so an over-long number can't wrap into a valid address
+static uint32_t parse_hex(const char **p) {
+    uint32_t v = 0;
+    int h;
+    while ((h = hex_val(**p)) >= 0) {
+        v = v > (UINT32_MAX >> 4) ? UINT32_MAX : (v << 4) | (uint32_t)h;
+        (*p)++;
+    }
+    return v;
+}
+
+static char *put_hex_bytes(char *out, const uint8_t *bytes, size_t n) {
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < n; ++i) {
+        *out++ = hex[bytes[i] >> 4];
+        *out++ = hex[bytes[i] & 0xF];
+    }
+    *out = '\0';
+    return out;
+}
+
+/* ---- registers ---- */
+
+static int reg_size(int n) {
+    if (n == REG_I || n == REG_PC || n >= REG_STACK) return 2;
+    return 1;
+}
+
+static uint16_t reg_get(const Chip8 *c, int n) {
+    if (n < 16) return c->cpu.V[n];
+    switch (n) {
+        case REG_I: return c->cpu.I;
+        case REG_PC: return c->cpu.pc;
+        case REG_SP: return c->cpu.sp;
+        case REG_DT: return c->cpu.delay_timer;
+        case REG_ST: return c->cpu.sound_timer;
+        default: return c->cpu.stack[n - REG_STACK];
+    }
+}
+
+static void reg_set(Chip8 *c, int n, uint16_t v) {
+    if (n < 16) {
+        c->cpu.V[n] = (uint8_t)v;
+        return;
+    }
+    switch (n) {
+        case REG_I: c->cpu.I = v; break;
+        case REG_PC: c->cpu.pc = (uint16_t)(v & (MEMORY_SIZE - 1)); break;
+        case REG_SP: c->cpu.sp = (uint8_t)(v > 16 ? 16 : v); break;
+        case REG_DT: c->cpu.delay_timer = (uint8_t)v; break;
+        case REG_ST: c->cpu.sound_timer = (uint8_t)v; break;
+        default: c->cpu.stack[n - REG_STACK] = v; break;
+    }
+}
+
+static char *put_reg(char *out, const Chip8 *c, int n) {
+    uint16_t v = reg_get(c, n);
+    uint8_t bytes[2] = { (uint8_t)v, (uint8_t)(v >> 8) };
+    return put_hex_bytes(out, bytes, (size_t)reg_size(n));
+}
+
+static const char *take_reg(const char *p, Chip8 *c, int n) {
+    uint16_t v = 0;
+    for (int b = 0; b < reg_size(n); ++b) {
+        int hi = hex_val(p[0]), lo = hex_val(p[1]);
+        if (hi < 0 || lo < 0) return NULL;
+        v |= (uint16_t)(((hi << 4) | lo) << (8 * b));
+        p += 2;
+    }
+    reg_set(c, n, v);
+    return p;
+}
+
+/* ---- commands ---- */
+
+static void handle_breakpoint(Debugger *d, const char *p, int insert) {
+    int type = p[0] - '0';
+    p += 1;
+    if (*p != ',') {
+        send_packet(d, "E01");
+        return;
+    }
+    p++;
+    uint32_t addr = parse_hex(&p);
+    uint32_t len = 1;
+    if (*p == ',') {
+        p++;
+        len = parse_hex(&p);
+    }
+    if (len == 0) len = 1;
+
+    if (type == 0 || type == 1) {
+        if (addr >= MEMORY_SIZE) {
+            send_packet(d, "E01");
+            return;
+        }
+        uint8_t bit = (uint8_t)(1u << (addr & 7));
+        int set = (d->breakpoints[addr >> 3] & bit) != 0;
+        if (insert && !set) {
+            d->breakpoints[addr >> 3] |= bit;
+            d->breakpoint_count++;
+        } else if (!insert && set) {
+            d->breakpoints[addr >> 3] &= (uint8_t)~bit;
+            d->breakpoint_count--;
+        }
+        send_packet(d, "OK");
+        return;
+    }
+
+    if (type < WATCH_WRITE || type > WATCH_ACCESS) {
+        send_packet(d, "");
+        return;
+    }
+    int is_reg = addr >= DEBUG_REG_BASE;
+    if (is_reg) len = 1;
+    if ((is_reg && addr > DEBUG_REG_BASE + REG_I) ||
+        (!is_reg && (addr >= MEMORY_SIZE || len > MEMORY_SIZE - addr))) {
+        send_packet(d, "E01");
+        return;
+    }
+
+    if (insert) {
+        if (d->watch_count == DEBUG_MAX_WATCH) {
+            send_packet(d, "E02");
+            return;
+        }
+        Watchpoint *w = &d->watch[d->watch_count++];
+        w->addr = addr;
+        w->len = len;
+        w->kind = (WatchKind)type;
+    } else {
+        for (int i = 0; i < d->watch_count; ++i) {
+            if (d->watch[i].addr == addr && d->watch[i].len == len && (int)d->watch[i].kind == type) {
+                d->watch[i] = d->watch[--d->watch_count];
+                break;
+            }
+        }
+    }
+    rebuild_watch_maps(d);
+    send_packet(d, "OK");
+}
+
+static void handle_packet(Debugger *d, Chip8 *c, const char *pkt) {
+    char out[DEBUG_PACKET_MAX];
+    const char *p = pkt + 1;
+
+    switch (pkt[0]) {
+        case '?':
+            send_packet(d, "S05");
+            break;
+
+        case 'g': {
+            char *o = out;
+            for (int n = 0; n < DEBUG_NUM_REGS; ++n) o = put_reg(o, c, n);
+            send_packet(d, out);
+            break;
+        }
+
+        case 'G':
+            for (int n = 0; n < DEBUG_NUM_REGS && p; ++n) p = take_reg(p, c, n);
+            send_packet(d, p ? "OK" : "E01");
+            break;
+
+        case 'p': {
+            uint32_t n = parse_hex(&p);
+            if (n >= DEBUG_NUM_REGS) {
+                send_packet(d, "E01");
+                break;
+            }
+            put_reg(out, c, (int)n);
+            send_packet(d, out);
+            break;
+        }
+
+        case 'P': {
+            uint32_t n = parse_hex(&p);
+            if (n >= DEBUG_NUM_REGS || *p != '=' || !take_reg(p + 1, c, (int)n)) {
+                send_packet(d, "E01");
+                break;
+            }
+            send_packet(d, "OK");
+            break;
+        }
+
+        case 'm': {
+            uint32_t addr = parse_hex(&p);
+            if (*p++ != ',') {
+                send_packet(d, "E01");
+                break;
+            }
+            uint32_t len = parse_hex(&p);
+            if (addr >= MEMORY_SIZE || len > (DEBUG_PACKET_MAX - 8) / 2) {
+                send_packet(d, "E01");
+                break;
+            }
+            if (len > MEMORY_SIZE - addr) len = MEMORY_SIZE - addr; // GDB reads past the end
+            put_hex_bytes(out, &c->memory.data[addr], len);
+            send_packet(d, out);
+            break;
+        }
+
+        case 'M': {
+            uint32_t addr = parse_hex(&p);
+            if (*p++ != ',') {
+                send_packet(d, "E01");
+                break;
+            }
+            uint32_t len = parse_hex(&p);
+            if (*p++ != ':' || addr >= MEMORY_SIZE || len > MEMORY_SIZE - addr) {
+                send_packet(d, "E01");
+                break;
+            }
+            for (uint32_t i = 0; i < len; ++i) {
+                int hi = hex_val(p[0]), lo = hex_val(p[1]);
+                if (hi < 0 || lo < 0) break;
+                c->memory.data[addr + i] = (uint8_t)((hi << 4) | lo);
+                p += 2;
+            }
+            send_packet(d, "OK");
+            break;
+        }
+
+        case 'c':
+        case 's':
+            if (*p) c->cpu.pc = (uint16_t)(parse_hex(&p) & (MEMORY_SIZE - 1));
+            d->halted = 0;
+            d->step = pkt[0] == 's';
+            d->resume_skip = 1;
+            break; // reply comes with the next stop
+
+        case 'Z':
+        case 'z':
+            handle_breakpoint(d, p, pkt[0] == 'Z');
+            break;
+
+        case 'H':
+            send_packet(d, "OK");
+            break;
+
+        case 'q':
+            if (strncmp(pkt, "qSupported", 10) == 0) {
+                snprintf(out, sizeof(out), "PacketSize=%x", DEBUG_PACKET_MAX);
+                send_packet(d, out);
+            } else if (strcmp(pkt, "qAttached") == 0) {
+                send_packet(d, "1");
+            } else if (strcmp(pkt, "qC") == 0) {
+                send_packet(d, "QC1");
+            } else if (strcmp(pkt, "qchip8.stack") == 0) {
+                int n = snprintf(out, sizeof(out), "%02x", c->cpu.sp);
+                for (int i = (int)c->cpu.sp - 1; i >= 0 && i < 16; --i) {
+                    n += snprintf(out + n, sizeof(out) - (size_t)n, ",%03x", c->cpu.stack[i]);
+                }
+                send_packet(d, out);
+            } else {
+                send_packet(d, "");
+            }
+            break;
+
+        case 'D':
+        case 'k':
+            send_packet(d, "OK");
+            memset(d->breakpoints, 0, sizeof(d->breakpoints));
+            d->breakpoint_count = 0;
+            d->watch_count = 0;
+            rebuild_watch_maps(d);
+            d->halted = 0;
+            close(d->client_fd);
+            d->client_fd = -1;
+            break;
+
+        default:
+            send_packet(d, "");
+            break;
+    }
+}
+
+/* ---- public API ---- */
+
+Debugger* debug_open(int port) {
+    Debugger *d = calloc(1, sizeof(Debugger));
+    if (!d) return NULL;
+    d->client_fd = -1;
+
+    d->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (d->listen_fd < 0) {
+        perror("socket");
+        free(d);
+        return NULL;
+    }
+    int one = 1;
+    setsockopt(d->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(d->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(d->listen_fd, 1) < 0) {
+        perror("bind/listen gdb");
+        close(d->listen_fd);
+        free(d);
+        return NULL;
+    }
+    fcntl(d->listen_fd, F_SETFL, fcntl(d->listen_fd, F_GETFL, 0) | O_NONBLOCK);
+    fprintf(stderr, "GDB stub listening on 127.0.0.1:%d\n", port);
+    return d;
+}
+
+int debug_attached(const Debugger *d) {
+    return d && d->client_fd >= 0;
+}
+
+void debug_poll(Debugger *d, Chip8 *c, int wait_ms) {
+    if (d->client_fd < 0) {
+        int fd = accept(d->listen_fd, NULL, NULL);
+        if (fd < 0) return;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        d->client_fd = fd;
+        d->in_len = 0;
+        d->halted = 1; // GDB expects the target stopped on attach
+        d->step = 0;
+    }
+
+    // While halted, wait for the front end so back-to-back requests are answered promptly
+    struct pollfd pfd = { d->client_fd, POLLIN, 0 };
+    int timeout = d->halted ? wait_ms : 0;
+    while (d->client_fd >= 0 && poll(&pfd, 1, timeout) > 0) {
+        ssize_t n = read(d->client_fd, d->in + d->in_len, sizeof(d->in) - 1 - (size_t)d->in_len);
+        if (n <= 0) {
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) break;
+            // Front end went away: drop every stop condition and let the program run
+            close(d->client_fd);
+            d->client_fd = -1;
+            memset(d->breakpoints, 0, sizeof(d->breakpoints));
+            d->breakpoint_count = 0;
+            d->watch_count = 0;
+            rebuild_watch_maps(d);
+            d->halted = 0;
+            return;
+        }
+        d->in_len += (int)n;
+
+        // Consume complete packets, acks and interrupts
+        int pos = 0;
+        while (pos < d->in_len) {
+            char ch = d->in[pos];
+            if (ch == 0x03) {
+                if (!d->halted) stop(d, "S02");
+                pos++;
+            } else if (ch != '$') {
+                pos++; // '+' / '-' acks and noise
+            } else {
+                char *end = memchr(d->in + pos, '#', (size_t)(d->in_len - pos));
+                if (!end || end + 2 >= d->in + d->in_len) break; // incomplete
+                *end = '\0';
+                send_raw(d, "+", 1);
+                handle_packet(d, c, d->in + pos + 1);
+                pos = (int)(end - d->in) + 3;
+                if (d->client_fd < 0) return;
+            }
+        }
+        memmove(d->in, d->in + pos, (size_t)(d->in_len - pos));
+        d->in_len -= pos;
+        if (d->in_len == (int)sizeof(d->in) - 1) d->in_len = 0; // oversized packet, resync
+        if (!d->halted) timeout = 0;
+    }
+}
+
+int debug_run_frame(Debugger *d, Chip8 *c, int cycles) {
+    int i;
+    for (i = 0; i < cycles && !d->halted; ++i) {
+        uint16_t pc = c->cpu.pc;
+        if (!d->resume_skip && d->breakpoint_count && pc < MEMORY_SIZE &&
+            (d->breakpoints[pc >> 3] & (1u << (pc & 7)))) {
+            stop(d, "S05");
+            return i;
+        }
+        d->resume_skip = 0;
+
+        Access a;
+        uint16_t op = 0;
+        int armed = d->watch_count > 0;
+        if (armed) {
+            op = cpu_fetch_opcode(&c->cpu, &c->memory);
+            decode_access(c, op, &a);
+        }
+
+        chip8_emulate_cycle(c);
+
+        if (armed) {
+            // FX0A only writes Vx once a key is down; while it waits the PC stays put
+            if ((op & 0xF0FF) == 0xF00A && c->cpu.pc == pc) a.reg_write = 0;
+            int hit = watch_hit(d, &a);
+            if (hit >= 0) {
+                static const char *const names[] = { "", "", "watch", "rwatch", "awatch" };
+                char reply[48];
+                snprintf(reply, sizeof(reply), "T05%s:%x;", names[d->watch[hit].kind], d->watch[hit].addr);
+                stop(d, reply);
+                return i + 1;
+            }
+        }
+        if (d->step) {
+            stop(d, "S05");
+            return i + 1;
+        }
+    }
+    return i;
+}
+
+void debug_close(Debugger *d) {
+    if (!d) return;
+    if (d->client_fd >= 0) {
+        send_packet(d, "W00"); // tell the front end the program exited
+        close(d->client_fd);
+    }
+    close(d->listen_fd);
+    free(d);
+}
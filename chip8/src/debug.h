@@ -0,0 +1,74 @@
+// debug.h
+
+/*
+Concepts:
+    Debugger with a GDB remote-serial-protocol stub on a local TCP port (--gdb PORT).
+    Supports PC breakpoints, read/write/access watchpoints on memory ranges and registers,
+    single-step, and register / memory / call stack inspection.
+    How does it stay free when unused? The runner only routes cycles through debug_run_frame
+    while a debugger is attached; otherwise chip8_run_frame runs untouched.
+    How are watchpoints cheap? Every CHIP-8 memory or register access can be read off the
+    opcode, so each instruction is decoded before it runs and its memory range is checked
+    against a bitmap of armed 16-byte granules. Only a hit in the bitmap walks the watch list.
+
+    Register numbers (for 'p'/'P' and the 'g' packet, in this order):
+        0-15  V0..VF (1 byte)     16  I (2 bytes)     17  PC (2 bytes)
+        18    SP (1 byte)         19  DT (1 byte)     20  ST (1 byte)
+        21-36 stack[0..15] (2 bytes each)
+    Multi-byte registers are little-endian, as GDB expects.
+    Watching a register: use address DEBUG_REG_BASE + register number (V0..VF, I only).
+*/
+
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include <stdint.h>
+#include "chip8.h"
+
+#define DEBUG_GRANULE_SHIFT 4
+#define DEBUG_GRANULES (MEMORY_SIZE >> DEBUG_GRANULE_SHIFT)
+#define DEBUG_MAX_WATCH 32
+#define DEBUG_REG_BASE 0x10000u
+#define DEBUG_NUM_REGS 37
+#define DEBUG_PACKET_MAX 4096
+
+typedef enum {
+    WATCH_WRITE = 2,   // GDB Z2
+    WATCH_READ = 3,    // GDB Z3
+    WATCH_ACCESS = 4   // GDB Z4
+} WatchKind;
+
+typedef struct {
+    uint32_t addr;
+    uint32_t len;
+    WatchKind kind;
+} Watchpoint;
+
+typedef struct {
+    int listen_fd;
+    int client_fd;
+    int halted;
+    int step;                                   // stop after one instruction
+    int resume_skip;                            // don't re-trigger the breakpoint we stopped on
+
+    uint8_t breakpoints[MEMORY_SIZE / 8];       // one bit per address
+    int breakpoint_count;
+
+    Watchpoint watch[DEBUG_MAX_WATCH];
+    int watch_count;
+    uint8_t read_granules[DEBUG_GRANULES / 8];  // granules with a read/access watch
+    uint8_t write_granules[DEBUG_GRANULES / 8]; // granules with a write/access watch
+    uint32_t reg_read_mask;                     // bit n = register n watched for reads
+    uint32_t reg_write_mask;
+
+    char in[DEBUG_PACKET_MAX];
+    int in_len;
+} Debugger;
+
+Debugger* debug_open(int port);
+int debug_attached(const Debugger *d);
+void debug_poll(Debugger *d, Chip8 *c, int wait_ms);
+int debug_run_frame(Debugger *d, Chip8 *c, int cycles);  // returns instructions executed
+void debug_close(Debugger *d);
+
+#endif
@@ -0,0 +1,126 @@
+// debug_check.c
+
+/*
+Concepts:
+    Protocol check for the GDB stub (debug.h).
+    Usage:
+        chip8-debug-check           exit status 0 when every packet gets the expected reply
+    Opens the stub on an ephemeral loopback port, connects to it as a front end would, and
+    sends memory and watchpoint packets whose address/length pairs sit at or past the end of
+    memory, including ones where addr + len wraps a 32-bit integer. Out-of-range requests must
+    be answered with E01 and leave memory untouched; in-range ones at the edge must still work.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "debug.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef struct {
+    const char *packet;  // body between '$' and '#'
+    const char *reply;   // expected reply body
+} Case;
+
+static const Case cases[] = {
+    // M: write memory
+    { "Mffffff00,200:00",           "E01" }, // addr + len wraps
+    { "M1000,1:00",                 "E01" }, // addr == MEMORY_SIZE
+    { "Mfff,2:0000",                "E01" }, // one byte past the end
+    { "M0,ffffffff:00",             "E01" },
+    { "M100000ffe,1:00",            "E01" }, // too many digits must not wrap to 0xffe
+    { "Mffe,2:abcd",                "OK" },  // last two bytes
+    // m: read memory
+    { "mffffff00,200",              "E01" },
+    { "m1000,1",                    "E01" },
+    { "m0,ffffffff",                "E01" },
+    { "mffe,2",                     "abcd" },
+    { "mfff,10",                    "cd" },  // reads past the end are cut short
+    // Z/z: watchpoints
+    { "Z2,ffffff00,200",            "E01" },
+    { "Z2,ff0,ffffff00",            "E01" }, // addr + len wraps
+    { "Z2,ff0,20",                  "E01" },
+    { "Z2,ff0,10",                  "OK" },
+    { "z2,ff0,10",                  "OK" },
+};
+
+static int send_packet(int fd, const char *body) {
+    char buf[DEBUG_PACKET_MAX];
+    unsigned sum = 0;
+    for (const char *p = body; *p; ++p) sum += (unsigned char)*p;
+    int n = snprintf(buf, sizeof(buf), "$%s#%02x", body, sum & 0xFF);
+    return write(fd, buf, (size_t)n) == n ? 0 : -1;
+}
+
+// Read one "$body#xx" reply (skipping the '+' ack) into body
+static int read_reply(int fd, char *body, size_t size) {
+    size_t len = 0;
+    int in_packet = 0;
+    char ch;
+    while (read(fd, &ch, 1) == 1) {
+        if (!in_packet) {
+            in_packet = ch == '$';
+            continue;
+        }
+        if (ch == '#') {
+            char sum[2];
+            if (read(fd, sum, 2) != 2) return -1;
+            body[len] = '\0';
+            return 0;
+        }
+        if (len + 1 < size) body[len++] = ch;
+    }
+    return -1;
+}
+
+int main(void) {
+    Debugger *d = debug_open(0);
+    if (!d) return 1;
+
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    getsockname(d->listen_fd, (struct sockaddr *)&addr, &addr_len);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, addr_len) < 0) {
+        perror("connect");
+        debug_close(d);
+        return 1;
+    }
+
+    static Chip8 chip8;
+    chip8_init(&chip8);
+    debug_poll(d, &chip8, 0); // accept
+
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        char reply[DEBUG_PACKET_MAX];
+        if (send_packet(fd, cases[i].packet) < 0) {
+            perror("write");
+            failures++;
+            break;
+        }
+        debug_poll(d, &chip8, 10); // loopback data is already there; don't linger
+        if (read_reply(fd, reply, sizeof(reply)) < 0) {
+            fprintf(stderr, "%-24s no reply\n", cases[i].packet);
+            failures++;
+            break;
+        }
+        if (strcmp(reply, cases[i].reply) != 0) {
+            fprintf(stderr, "%-24s got \"%s\", expected \"%s\"\n", cases[i].packet, reply, cases[i].reply);
+            failures++;
+        }
+    }
+
+    debug_close(d);
+    close(fd);
+    if (failures) {
+        fprintf(stderr, "debug check: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("debug check: %zu packets OK\n", sizeof(cases) / sizeof(cases[0]));
+    return 0;
+}
@@ -4,14 +4,19 @@
 #include "SDL.h"
 #include <stdlib.h>
 
-Display* display_init(void) {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
+Display* display_init(const FilterConfig *cfg) {
+    // Video only; audio is initialised lazily by sound.c on the first beep
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
         fprintf(stderr, "SDL Init failed: %s\n", SDL_GetError());
         return NULL;
     }
     
     Display *d = malloc(sizeof(Display));
     if (!d) return NULL;
+
+    FilterConfig defaults;
+    filter_default_config(&defaults);
+    filter_init(&d->filter, cfg ? cfg : &defaults);
     
     d->window = SDL_CreateWindow("CHIP-8 Emulator", 
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
@@ -31,7 +36,7 @@ Display* display_init(void) {
     
     d->texture = SDL_CreateTexture(d->renderer,
         SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING,
-        64, 32);
+        filter_width(&d->filter), filter_height(&d->filter));
     
     if (!d->texture) {
         SDL_DestroyRenderer(d->renderer);
@@ -44,17 +49,22 @@ Display* display_init(void) {
 }
 
 void display_render(Display *d, const uint8_t *gfx) {
-    uint32_t pixels[64 * 32];
-    for (int i = 0; i < 64 * 32; i++) {
-        pixels[i] = gfx[i] ? 0xFFFFFFFF : 0x00000000;
-    }
-    
-    SDL_UpdateTexture(d->texture, NULL, pixels, 64 * sizeof(uint32_t));
+    // Filter straight into the streaming texture, no intermediate copy
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(d->texture, NULL, &pixels, &pitch) != 0) return;
+    filter_apply(&d->filter, gfx, pixels, pitch / (int)sizeof(uint32_t));
+    SDL_UnlockTexture(d->texture);
+
     SDL_RenderClear(d->renderer);
     SDL_RenderCopy(d->renderer, d->texture, NULL, NULL);
     SDL_RenderPresent(d->renderer);
 }
 
+int display_needs_frame(const Display *d) {
+    return d->filter.settling; // phosphor still fading
+}
+
 void display_cleanup(Display *d) {
     if (d) {
         if (d->texture) SDL_DestroyTexture(d->texture);
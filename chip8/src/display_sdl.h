@@ -5,15 +5,18 @@
 
 #include <stdint.h>
 #include <SDL.h>
+#include "filter.h"
 
 typedef struct {
     SDL_Window *window;
     SDL_Renderer *renderer;
     SDL_Texture *texture;
+    Filter filter;       // palette, scaling and effects applied before upload
 } Display;
 
-Display* display_init(void);
+Display* display_init(const FilterConfig *cfg);
 void display_render(Display *d, const uint8_t *gfx);
+int display_needs_frame(const Display *d);
 void display_cleanup(Display *d);
 int display_handle_input(Display *d, uint8_t *keys);
 
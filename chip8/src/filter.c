@@ -0,0 +1,240 @@
+// filter.c
+
+/*
+Concepts:
+    Implementation of filter.h for the CHIP-8 emulator.
+    How is the blend done without division? Brightness 0-255 is widened to 0-256
+    (l + (l >> 7)), then color = (on * l + off * (256 - l)) >> 8 per channel. Every product fits
+    in an unsigned 16-bit lane, so SSE2/AVX2 can do eight or sixteen channels per multiply.
+    How is the ISA picked? x86 builds ask the CPU for AVX2 at runtime (the AVX2 functions are
+    compiled with a target attribute, so no global -mavx2 is needed) and otherwise use SSE2,
+    which every x86-64 CPU has. Other targets use the scalar code.
+    CHIP8_FILTER_ISA=scalar|sse2 forces a slower path, for comparing or benchmarking.
+*/
+
+#include "filter.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define FILTER_X86 1
+#include <immintrin.h>
+#endif
+
+enum { ISA_SCALAR, ISA_SSE2, ISA_AVX2 };
+
+static int filter_pick_isa(void) {
+    const char *force = getenv("CHIP8_FILTER_ISA");
+    if (force && strcmp(force, "scalar") == 0) return ISA_SCALAR;
+#ifdef FILTER_X86
+    if (force && strcmp(force, "sse2") == 0) return ISA_SSE2;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ISA_AVX2;
+    return ISA_SSE2;
+#else
+    return ISA_SCALAR;
+#endif
+}
+
+const char *filter_isa(const Filter *f) {
+    static const char *const names[] = { "scalar", "sse2", "avx2" };
+    return names[f->isa];
+}
+
+/* ---- scalar ---- */
+
+// Returns nonzero if any unlit pixel is still glowing
+static int levels_scalar(uint8_t *level, const uint8_t *gfx, uint8_t decay) {
+    int glowing = 0;
+    for (int i = 0; i < DISPLAY_SIZE; ++i) {
+        uint8_t faded = (uint8_t)((level[i] * decay) >> 8);
+        level[i] = gfx[i] ? 0xFF : faded;
+        glowing |= gfx[i] ? 0 : faded;
+    }
+    return glowing != 0;
+}
+
+static void colors_scalar(uint32_t *row, const uint8_t *level, uint32_t on, uint32_t off) {
+    for (int x = 0; x < DISPLAY_WIDTH; ++x) {
+        uint32_t l = level[x] + (level[x] >> 7u);
+        uint32_t c = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            uint32_t a = (on >> shift) & 0xFF, b = (off >> shift) & 0xFF;
+            c |= (((a * l + b * (256 - l)) >> 8) & 0xFF) << shift;
+        }
+        row[x] = c;
+    }
+}
+
+/* ---- SSE2 ---- */
+
+#ifdef FILTER_X86
+static int levels_sse2(uint8_t *level, const uint8_t *gfx, uint8_t decay) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mul = _mm_set1_epi16(decay);
+    __m128i glow = zero;
+    for (int i = 0; i < DISPLAY_SIZE; i += 16) {
+        __m128i g = _mm_loadu_si128((const __m128i *)&gfx[i]);
+        __m128i lit = _mm_xor_si128(_mm_cmpeq_epi8(g, zero), _mm_set1_epi8(-1));
+        __m128i l = _mm_loadu_si128((const __m128i *)&level[i]);
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(l, zero), mul), 8);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(l, zero), mul), 8);
+        __m128i faded = _mm_packus_epi16(lo, hi);
+        glow = _mm_or_si128(glow, _mm_andnot_si128(lit, faded));
+        _mm_storeu_si128((__m128i *)&level[i], _mm_or_si128(lit, faded));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(glow, zero)) != 0xFFFF;
+}
+
+static void colors_sse2(uint32_t *row, const uint8_t *level, uint32_t on, uint32_t off) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(256);
+    const __m128i on16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)on), zero);   // 2 pixels of channels
+    const __m128i off16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)off), zero);
+
+    for (int x = 0; x < DISPLAY_WIDTH; x += 4) {
+        uint32_t four;
+        memcpy(&four, &level[x], 4);
+        __m128i l = _mm_cvtsi32_si128((int)four);
+        l = _mm_unpacklo_epi8(l, l);
+        l = _mm_unpacklo_epi16(l, l);                 // each level repeated over its 4 channels
+
+        __m128i lo = _mm_unpacklo_epi8(l, zero);      // pixels 0-1
+        __m128i hi = _mm_unpackhi_epi8(l, zero);      // pixels 2-3
+        lo = _mm_add_epi16(lo, _mm_srli_epi16(lo, 7));
+        hi = _mm_add_epi16(hi, _mm_srli_epi16(hi, 7));
+
+        __m128i clo = _mm_add_epi16(_mm_mullo_epi16(on16, lo), _mm_mullo_epi16(off16, _mm_sub_epi16(full, lo)));
+        __m128i chi = _mm_add_epi16(_mm_mullo_epi16(on16, hi), _mm_mullo_epi16(off16, _mm_sub_epi16(full, hi)));
+        __m128i px = _mm_packus_epi16(_mm_srli_epi16(clo, 8), _mm_srli_epi16(chi, 8));
+        _mm_storeu_si128((__m128i *)&row[x], px);
+    }
+}
+
+/* ---- AVX2 ---- */
+
+__attribute__((target("avx2")))
+static int levels_avx2(uint8_t *level, const uint8_t *gfx, uint8_t decay) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mul = _mm256_set1_epi16(decay);
+    __m256i glow = zero;
+    for (int i = 0; i < DISPLAY_SIZE; i += 32) {
+        __m256i g = _mm256_loadu_si256((const __m256i *)&gfx[i]);
+        __m256i lit = _mm256_xor_si256(_mm256_cmpeq_epi8(g, zero), _mm256_set1_epi8(-1));
+        __m256i l = _mm256_loadu_si256((const __m256i *)&level[i]);
+        // unpack/pack work within 128-bit lanes, so byte order survives the round trip
+        __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(l, zero), mul), 8);
+        __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(l, zero), mul), 8);
+        __m256i faded = _mm256_packus_epi16(lo, hi);
+        glow = _mm256_or_si256(glow, _mm256_andnot_si256(lit, faded));
+        _mm256_storeu_si256((__m256i *)&level[i], _mm256_or_si256(lit, faded));
+    }
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(glow, zero)) != 0xFFFFFFFFu;
+}
+
+__attribute__((target("avx2")))
+static void colors_avx2(uint32_t *row, const uint8_t *level, uint32_t on, uint32_t off) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi16(256);
+    const __m256i splat = _mm256_set1_epi32(0x01010101);
+    const __m256i on16 = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)on), zero);
+    const __m256i off16 = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)off), zero);
+
+    for (int x = 0; x < DISPLAY_WIDTH; x += 8) {
+        __m128i eight = _mm_loadl_epi64((const __m128i *)&level[x]);
+        __m256i l = _mm256_mullo_epi32(_mm256_cvtepu8_epi32(eight), splat); // level in every channel
+
+        __m256i lo = _mm256_unpacklo_epi8(l, zero);   // pixels 0-1 | 4-5
+        __m256i hi = _mm256_unpackhi_epi8(l, zero);   // pixels 2-3 | 6-7
+        lo = _mm256_add_epi16(lo, _mm256_srli_epi16(lo, 7));
+        hi = _mm256_add_epi16(hi, _mm256_srli_epi16(hi, 7));
+
+        __m256i clo = _mm256_add_epi16(_mm256_mullo_epi16(on16, lo), _mm256_mullo_epi16(off16, _mm256_sub_epi16(full, lo)));
+        __m256i chi = _mm256_add_epi16(_mm256_mullo_epi16(on16, hi), _mm256_mullo_epi16(off16, _mm256_sub_epi16(full, hi)));
+        __m256i px = _mm256_packus_epi16(_mm256_srli_epi16(clo, 8), _mm256_srli_epi16(chi, 8));
+        _mm256_storeu_si256((__m256i *)&row[x], px);
+    }
+}
+#endif
+
+/* ---- public API ---- */
+
+void filter_default_config(FilterConfig *cfg) {
+    cfg->on = 0xFFFFFFFF;
+    cfg->off = 0x00000000;
+    cfg->scale = 1;
+    cfg->phosphor = 0;
+    cfg->scanlines = 0;
+}
+
+static uint32_t dim(uint32_t c) {
+    // Halve R, G and B; keep alpha
+    return ((c >> 1) & 0x7F7F7F00u) | (c & 0xFFu);
+}
+
+void filter_init(Filter *f, const FilterConfig *cfg) {
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    if (f->cfg.scale < 1) f->cfg.scale = 1;
+    if (f->cfg.scale > FILTER_MAX_SCALE) f->cfg.scale = FILTER_MAX_SCALE;
+    if (f->cfg.phosphor < 0) f->cfg.phosphor = 0;
+    if (f->cfg.phosphor > 99) f->cfg.phosphor = 99;
+    f->decay = (uint8_t)(f->cfg.phosphor * 256 / 100);
+    f->dim_on = dim(f->cfg.on);
+    f->dim_off = dim(f->cfg.off);
+    f->isa = filter_pick_isa();
+}
+
+int filter_width(const Filter *f) {
+    return DISPLAY_WIDTH * f->cfg.scale;
+}
+
+int filter_height(const Filter *f) {
+    return DISPLAY_HEIGHT * f->cfg.scale;
+}
+
+static void stretch_row(uint32_t *dst, const uint32_t *src, int scale) {
+    if (scale == 1) {
+        memcpy(dst, src, DISPLAY_WIDTH * sizeof(uint32_t));
+        return;
+    }
+    for (int x = 0; x < DISPLAY_WIDTH; ++x) {
+        uint32_t c = src[x];
+        for (int k = 0; k < scale; ++k) *dst++ = c;
+    }
+}
+
+void filter_apply(Filter *f, const uint8_t *gfx, uint32_t *out, int pitch) {
+    const int scale = f->cfg.scale;
+    const int width = filter_width(f);
+    const int dim_last = f->cfg.scanlines && scale > 1;
+    uint32_t row[DISPLAY_WIDTH], dim_row[DISPLAY_WIDTH];
+
+    int (*levels)(uint8_t *, const uint8_t *, uint8_t) = levels_scalar;
+    void (*colors)(uint32_t *, const uint8_t *, uint32_t, uint32_t) = colors_scalar;
+#ifdef FILTER_X86
+    if (f->isa == ISA_AVX2) {
+        levels = levels_avx2;
+        colors = colors_avx2;
+    } else if (f->isa == ISA_SSE2) {
+        levels = levels_sse2;
+        colors = colors_sse2;
+    }
+#endif
+
+    f->settling = levels(f->level, gfx, f->decay);
+
+    for (int y = 0; y < DISPLAY_HEIGHT; ++y) {
+        const uint8_t *lv = &f->level[y * DISPLAY_WIDTH];
+        colors(row, lv, f->cfg.on, f->cfg.off);
+        if (dim_last) colors(dim_row, lv, f->dim_on, f->dim_off);
+
+        uint32_t *dst = out + (size_t)y * (size_t)scale * (size_t)pitch;
+        stretch_row(dst, row, scale);
+        for (int r = 1; r < scale; ++r) {
+            uint32_t *line = dst + (size_t)r * (size_t)pitch;
+            if (dim_last && r == scale - 1) stretch_row(line, dim_row, scale);
+            else memcpy(line, dst, (size_t)width * sizeof(uint32_t));
+        }
+    }
+}
@@ -0,0 +1,50 @@
+// filter.h
+
+/*
+Concepts:
+    Output stage: turns the 0/1 gfx buffer into scaled palette pixels on the CPU.
+    Step 1 (levels): every pixel gets a brightness 0-255. Lit pixels are 255; with phosphor
+    enabled an unlit pixel keeps a fraction of last frame's brightness, so it fades instead of
+    vanishing. That also hides most of the flicker from XOR-drawn sprites being erased and
+    redrawn.
+    Step 2 (colors): brightness is blended between the off and on palette colors, 64 pixels at
+    a time, into one row. With scanlines, a second, half-bright row is made the same way.
+    Step 3 (scale): each color is repeated `scale` times across and the row `scale` times down;
+    the last copy uses the scanline row.
+    Steps 1 and 2 have SSE2 and AVX2 versions picked at runtime, with a scalar fallback.
+    Pixels are 32-bit 0xRRGGBBAA, matching SDL_PIXELFORMAT_RGBA8888.
+*/
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include "chip8.h"
+
+#define FILTER_MAX_SCALE 64
+
+typedef struct {
+    uint32_t on;        // lit pixel color, 0xRRGGBBAA
+    uint32_t off;       // unlit pixel color
+    int scale;          // integer upscale, 1..FILTER_MAX_SCALE
+    int phosphor;       // percent of brightness kept per frame once a pixel turns off, 0 = off
+    int scanlines;      // darken the last row of every scaled pixel row
+} FilterConfig;
+
+typedef struct {
+    FilterConfig cfg;
+    uint8_t decay;                 // phosphor as a 0-255 multiplier
+    int settling;                  // some pixel is still fading; keep presenting frames
+    int isa;                       // SIMD path picked at init
+    uint32_t dim_on, dim_off;      // scanline palette
+    uint8_t level[DISPLAY_SIZE];   // per-pixel brightness
+} Filter;
+
+void filter_default_config(FilterConfig *cfg);
+void filter_init(Filter *f, const FilterConfig *cfg);
+int filter_width(const Filter *f);
+int filter_height(const Filter *f);
+void filter_apply(Filter *f, const uint8_t *gfx, uint32_t *out, int pitch);
+const char *filter_isa(const Filter *f);
+
+#endif
@@ -1,54 +1,316 @@
 // main.c
 
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include "capture.h"
 #include "chip8.h"
+#include "debug.h"
 #include "display_sdl.h"
 #include "sound.h"
+#include "stats.h"
+#include "term.h"
+
+// SIGINT / SIGTERM end the loop normally so captures and stats are closed properly
+static volatile sig_atomic_t quit_requested = 0;
+
+static void on_quit_signal(int sig) {
+    (void)sig;
+    quit_requested = 1;
+}
+
+static uint64_t ts_ns(const struct timespec *t) {
+    return (uint64_t)t->tv_sec * 1000000000ull + (uint64_t)t->tv_nsec;
+}
+
+// "RRGGBB,RRGGBB" (lit, unlit) -> 0xRRGGBBAA colors
+static int parse_palette(const char *s, FilterConfig *cfg) {
+    unsigned int on, off;
+    if (sscanf(s, "%6x,%6x", &on, &off) != 2) return -1;
+    cfg->on = (on << 8) | 0xFF;
+    cfg->off = (off << 8) | 0xFF;
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] <rom | builtin:NAME>\n", prog);
+    fprintf(stderr, "  --term           render in the terminal instead of an SDL window\n");
+    fprintf(stderr, "  --headless       no display, sound or input\n");
+    fprintf(stderr, "  --fast           run unthrottled instead of at 60 frames per second\n");
+    fprintf(stderr, "  --frames N       exit after N frames\n");
+    fprintf(stderr, "  --capture FILE   record video (.c8v delta, .y4m or .rgb)\n");
+    fprintf(stderr, "  --capture-wav F  record the beeper as WAV\n");
+    fprintf(stderr, "  --capture-scale N  integer scale for .y4m / .rgb capture\n");
+    fprintf(stderr, "                   (default 1, or the display scale with --scanlines)\n");
+    fprintf(stderr, "  --scale N        integer scale done on the CPU before upload (default 1)\n");
+    fprintf(stderr, "  --palette FG,BG  lit and unlit colors as RRGGBB hex (default ffffff,000000)\n");
+    fprintf(stderr, "  --phosphor PCT   fade unlit pixels, keeping PCT%% brightness per frame\n");
+    fprintf(stderr, "  --scanlines      darken every scaled pixel's last row\n");
+    fprintf(stderr, "  --gdb PORT       GDB remote stub on 127.0.0.1:PORT\n");
+    fprintf(stderr, "  --stats          publish live metrics to shared memory (read with chip8-stats)\n");
+    fprintf(stderr, "  --run-ahead N    present the frame N frames ahead to cut input latency\n");
+}
 
 int main(int argc, char **argv) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <rom>\n", argv[0]);
+    // Set by chip8-bench-startup: CLOCK_MONOTONIC just before this process was forked
+    const char *startup_env = getenv("CHIP8_STARTUP_T0");
+    uint64_t startup_t0 = startup_env ? strtoull(startup_env, NULL, 10) : 0;
+    uint64_t first_instruction_ns = 0;
+
+    const char *rom = NULL;
+    int stats_enabled = 0;
+    int run_ahead = 0;
+    int use_term = 0;
+    int headless = 0;
+    int fast = 0;
+    long max_frames = 0;
+    const char *capture_path = NULL;
+    const char *capture_wav = NULL;
+    int capture_scale = 1;
+    int gdb_port = 0;
+    FilterConfig filter;
+    filter_default_config(&filter);
+    int scale_given = 0;
+    int capture_scale_given = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--term") == 0) {
+            use_term = 1;
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = 1;
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            fast = 1;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capture_path = argv[++i];
+        } else if (strcmp(argv[i], "--capture-wav") == 0 && i + 1 < argc) {
+            capture_wav = argv[++i];
+        } else if (strcmp(argv[i], "--capture-scale") == 0 && i + 1 < argc) {
+            capture_scale = atoi(argv[++i]);
+            capture_scale_given = 1;
+            if (capture_scale < 1 || capture_scale > 64) {
+                fprintf(stderr, "--capture-scale must be between 1 and 64\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            filter.scale = atoi(argv[++i]);
+            scale_given = 1;
+            if (filter.scale < 1 || filter.scale > FILTER_MAX_SCALE) {
+                fprintf(stderr, "--scale must be between 1 and %d\n", FILTER_MAX_SCALE);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--palette") == 0 && i + 1 < argc) {
+            if (parse_palette(argv[++i], &filter) != 0) {
+                fprintf(stderr, "--palette expects RRGGBB,RRGGBB\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--phosphor") == 0 && i + 1 < argc) {
+            filter.phosphor = atoi(argv[++i]);
+            if (filter.phosphor < 0 || filter.phosphor > 99) {
+                fprintf(stderr, "--phosphor must be between 0 and 99\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scanlines") == 0) {
+            filter.scanlines = 1;
+        } else if (strcmp(argv[i], "--gdb") == 0 && i + 1 < argc) {
+            gdb_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats_enabled = 1;
+        } else if (strcmp(argv[i], "--run-ahead") == 0 && i + 1 < argc) {
+            run_ahead = atoi(argv[++i]);
+            if (run_ahead < 0 || run_ahead > 8) {
+                fprintf(stderr, "--run-ahead must be between 0 and 8\n");
+                return 1;
+            }
+        } else if (argv[i][0] == '-' || rom) {
+            usage(argv[0]);
+            return 1;
+        } else {
+            rom = argv[i];
+        }
+    }
+    if (!rom) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (filter.scanlines && scale_given && filter.scale < 2) {
+        fprintf(stderr, "--scanlines needs --scale 2 or more\n");
         return 1;
     }
+    if (filter.scanlines && capture_scale_given && capture_scale < 2) {
+        fprintf(stderr, "--scanlines needs --capture-scale 2 or more\n");
+        return 1;
+    }
+    // Captures default to 1x, which has no room for scanlines: follow the display scale instead
+    if (filter.scanlines && !capture_scale_given) capture_scale = scale_given ? filter.scale : 10;
 
     // Initialize emulator
     Chip8 sys;
     chip8_init(&sys);
-    chip8_load_rom(&sys, argv[1]);
+    chip8_load_rom(&sys, rom);
 
-    // Initialize display and sound
-    Display *display = display_init();
-    if (!display) {
-        fprintf(stderr, "Failed to initialize display\n");
-        return 1;
+    Stats stats = { 0 };
+    if (stats_enabled && stats_open(&stats, rom) != 0) {
+        fprintf(stderr, "Stats disabled\n");
+    }
+
+    Debugger *dbg = NULL;
+    if (gdb_port > 0) {
+        dbg = debug_open(gdb_port);
+        if (!dbg) {
+            fprintf(stderr, "Failed to start GDB stub\n");
+            return 1;
+        }
+    }
+
+    Capture *capture = NULL;
+    if (capture_path || capture_wav) {
+        FilterConfig capture_filter = filter;
+        capture_filter.scale = capture_scale;
+        capture = capture_open(capture_path, capture_wav, &capture_filter);
+        if (!capture) {
+            fprintf(stderr, "Failed to start capture\n");
+            return 1;
+        }
+    }
+
+    // Initialize display and sound; the terminal backend rings the bell instead of using SDL audio
+    Display *display = NULL;
+    Term *term = NULL;
+    if (headless) {
+        // Nothing to open: frames only go to capture and stats
+    } else if (use_term) {
+        term = term_init();
+        if (!term) {
+            fprintf(stderr, "Failed to initialize terminal\n");
+            return 1;
+        }
+    } else {
+        // Scanlines need at least two rows per pixel; without --scale use the window's native 10x
+        if (filter.scanlines && !scale_given) filter.scale = 10;
+        display = display_init(&filter);
+        if (!display) {
+            fprintf(stderr, "Failed to initialize display\n");
+            return 1;
+        }
+        sound_init();
     }
-    sound_init();
 
     // Main loop variables
     const int cycles_per_frame = 10;
     const double target_frame_time = 1.0 / 60.0; // 60 FPS
+
+    // Run-ahead: the speculative copy is emulated N frames past the real state with the
+    // current keys, shown, then thrown away (the real state is never touched, so dropping
+    // the copy is the rollback)
+    // A misprediction can leave a speculative frame on screen that no later frame redraws,
+    // so with run-ahead the decision to render is made against what was last presented
+    Chip8 ahead;
+    uint64_t run_ahead_ns = 0, run_ahead_frames = 0;
+    uint8_t presented[DISPLAY_SIZE] = { 0 };
+
+    // Input-to-photon latency, measured the same way with and without run-ahead: from the
+    // poll that saw a key press to the present of the first frame that differs from what
+    // was on screen. A press with no visible effect within latency_window_ns is dropped.
+    const uint64_t latency_window_ns = 500000000ull;
+    uint64_t key_change_ns = 0;
+    uint64_t latency_ns_total = 0, latency_samples = 0;
+
+    // Unthrottled runs tick timers once per emulated frame instead of by the wall clock
+    const int paced = !fast;
+    long frames = 0;
     
     struct timespec last_timer, frame_start;
     clock_gettime(CLOCK_MONOTONIC, &last_timer);
 
+    signal(SIGINT, on_quit_signal);
+    signal(SIGTERM, on_quit_signal);
+
     int running = 1;
-    while (running) {
+    while (running && !quit_requested) {
         clock_gettime(CLOCK_MONOTONIC, &frame_start);
 
         // Handle input
-        running = display_handle_input(display, sys.keys);
+        uint8_t keys_before[16];
+        memcpy(keys_before, sys.keys, sizeof(keys_before));
+        if (term) running = term_handle_input(term, &sys);
+        else if (display) running = display_handle_input(display, sys.keys);
+        int pressed = 0;
+        for (int k = 0; k < 16; ++k) pressed |= sys.keys[k] && !keys_before[k];
+        if (pressed) {
+            struct timespec polled;
+            clock_gettime(CLOCK_MONOTONIC, &polled);
+            key_change_ns = ts_ns(&polled); // the latest press is the one a change answers
+        }
+
+        // Run CPU cycles; only an attached debugger pays for per-instruction checks
+        if (dbg) debug_poll(dbg, &sys, 10);
+        if (startup_t0 && !first_instruction_ns) {
+            struct timespec first_instruction;
+            clock_gettime(CLOCK_MONOTONIC, &first_instruction);
+            first_instruction_ns = ts_ns(&first_instruction) - startup_t0;
+        }
+        int executed = cycles_per_frame;
+        if (debug_attached(dbg)) executed = debug_run_frame(dbg, &sys, cycles_per_frame);
+        else chip8_run_frame(&sys, cycles_per_frame);
+        int halted = dbg && dbg->halted;
 
-        // Run CPU cycles
-        for (int i = 0; i < cycles_per_frame; ++i) {
-            chip8_emulate_cycle(&sys);
+        // Speculate ahead; only the last speculative frame is rendered
+        const Chip8 *shown = &sys;
+        if (run_ahead > 0 && !halted) {
+            struct timespec ahead_start, ahead_end;
+            clock_gettime(CLOCK_MONOTONIC, &ahead_start);
+            chip8_snapshot(&sys, &ahead);
+            for (int f = 0; f < run_ahead; ++f) {
+                chip8_tick_timers(&ahead);
+                chip8_run_frame(&ahead, cycles_per_frame);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &ahead_end);
+            run_ahead_ns += ts_ns(&ahead_end) - ts_ns(&ahead_start);
+            run_ahead_frames++;
+            shown = &ahead;
         }
 
-        // Render if draw flag is set
-        if (sys.draw_flag) {
-            display_render(display, sys.gfx);
+        // Render if draw flag is set (with run-ahead: if the frame differs from the one on
+        // screen), or while phosphor is still fading out. Stats count only real cycles;
+        // speculative ones are thrown away.
+        StatsFrame frame_stats = { 0 };
+        frame_stats.instructions = (uint32_t)executed;
+        int changed = run_ahead > 0 ? memcmp(shown->gfx, presented, DISPLAY_SIZE) != 0
+                                    : shown->draw_flag;
+        if (changed || (display && display_needs_frame(display))) {
+            struct timespec render_start, render_end;
+            clock_gettime(CLOCK_MONOTONIC, &render_start);
+            if (term) term_render(term, shown->gfx);
+            else if (display) display_render(display, shown->gfx);
+            clock_gettime(CLOCK_MONOTONIC, &render_end);
             sys.draw_flag = 0;
+            if (key_change_ns && (display || term) && memcmp(presented, shown->gfx, DISPLAY_SIZE) != 0) {
+                uint64_t lat = ts_ns(&render_end) - key_change_ns;
+                if (lat <= latency_window_ns) {
+                    latency_ns_total += lat;
+                    latency_samples++;
+                }
+                key_change_ns = 0;
+            }
+            memcpy(presented, shown->gfx, DISPLAY_SIZE);
+            frame_stats.rendered = (display || term) ? 1 : 0;
+            frame_stats.render_ns = ts_ns(&render_end) - ts_ns(&render_start);
+        }
+
+        // Capture every frame, drawn or not, so the recording keeps real time
+        if (capture) capture_push(capture, shown->gfx, sys.cpu.sound_timer > 0);
+
+        if (startup_t0) {
+            struct timespec first_frame;
+            clock_gettime(CLOCK_MONOTONIC, &first_frame);
+            fprintf(stderr, "startup: first_instruction_ns=%llu first_frame_ns=%llu\n",
+                    (unsigned long long)first_instruction_ns,
+                    (unsigned long long)(ts_ns(&first_frame) - startup_t0));
+            startup_t0 = 0;
         }
 
         // Update timers at 60Hz
@@ -57,15 +319,14 @@ int main(int argc, char **argv) {
         double diff = (now.tv_sec - last_timer.tv_sec) + 
                      (now.tv_nsec - last_timer.tv_nsec) / 1e9;
         
-        if (diff >= (1.0 / 60.0)) {
-            if (sys.cpu.delay_timer > 0) sys.cpu.delay_timer--;
-            
-            if (sys.cpu.sound_timer > 0) {
-                sound_play_beep();
-                sys.cpu.sound_timer--;
-            } else {
-                sound_stop_beep();
+        if (!halted && (!paced || diff >= (1.0 / 60.0))) {
+            if (term) {
+                term_set_beep(term, sys.cpu.sound_timer > 0);
+            } else if (display) {
+                if (sys.cpu.sound_timer > 0) sound_play_beep();
+                else sound_stop_beep();
             }
+            chip8_tick_timers(&sys);
             
             last_timer = now;
         }
@@ -75,18 +336,51 @@ int main(int argc, char **argv) {
         double frame_time = (now.tv_sec - frame_start.tv_sec) + 
                            (now.tv_nsec - frame_start.tv_nsec) / 1e9;
         
-        if (frame_time < target_frame_time) {
+        frame_stats.frame_ns = (uint64_t)(frame_time * 1e9);
+
+        if (max_frames > 0 && ++frames >= max_frames) running = 0;
+
+        if (paced && frame_time < target_frame_time) {
             struct timespec sleep_time;
             double sleep_sec = target_frame_time - frame_time;
             sleep_time.tv_sec = (time_t)sleep_sec;
             sleep_time.tv_nsec = (long)((sleep_sec - sleep_time.tv_sec) * 1e9);
             nanosleep(&sleep_time, NULL);
+
+            if (stats.slot) {
+                struct timespec woke;
+                clock_gettime(CLOCK_MONOTONIC, &woke);
+                uint64_t wanted = ts_ns(&now) + (uint64_t)(sleep_sec * 1e9);
+                if (ts_ns(&woke) > wanted) frame_stats.sleep_overshoot_ns = ts_ns(&woke) - wanted;
+                now = woke;
+            }
+        } else if (paced) {
+            frame_stats.dropped = 1;
         }
+
+        if (stats.slot) stats_publish(&stats, &frame_stats, ts_ns(&now));
     }
 
     // Cleanup
-    sound_cleanup();
-    display_cleanup(display);
+    debug_close(dbg);
+    capture_close(capture);
+    stats_close(&stats);
+    if (term) {
+        term_cleanup(term);
+    } else if (display) {
+        sound_cleanup();
+        display_cleanup(display);
+    }
+
+    if (run_ahead_frames > 0) {
+        printf("Run-ahead: %d frame(s), %.2f us/frame CPU cost\n",
+               run_ahead, run_ahead_ns / 1e3 / (double)run_ahead_frames);
+    }
+    if (latency_samples > 0) {
+        printf("Input latency: %.1f ms average over %llu key presses (key seen -> changed frame presented)\n",
+               latency_ns_total / 1e6 / (double)latency_samples, (unsigned long long)latency_samples);
+    }
+
     printf("Exiting emulator.\n");
     return 0;
 }
\ No newline at end of file
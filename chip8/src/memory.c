@@ -9,6 +9,8 @@ Concepts:
     How is this initialized? By setting all memory bytes to zero.
 
     What does memory_load_rom function do? It loads a ROM file into the memory starting at address 0x200.
+    What does memory_load_rom_data do? The same for a ROM that is already in memory, like the
+    ones embedded in the binary (rompack.h), so no file I/O happens at all.
 */
 #include "memory.h"
 #include <stdio.h>
@@ -53,6 +55,20 @@ void memory_load_rom(Memory *m, const char *filename) {
     fclose(f);
 }
 
+void memory_load_rom_data(Memory *m, const uint8_t *data, size_t size) {
+    if (size == 0) {
+        fprintf(stderr, "Empty ROM\n");
+        exit(1);
+    }
+
+    if (ROM_START + size > MEMORY_SIZE) {
+        fprintf(stderr, "ROM too large to fit memory\n");
+        exit(1);
+    }
+
+    memcpy(&m->data[ROM_START], data, size);
+}
+
 uint8_t memory_read(Memory *m, uint16_t address) {
     if (address >= MEMORY_SIZE) return 0;
     return m->data[address];
@@ -12,6 +12,7 @@ Concept
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define MEMORY_SIZE 4096
@@ -23,6 +24,7 @@ typedef struct {
 
 void memory_init(Memory *m);
 void memory_load_rom(Memory *m, const char *filename);
+void memory_load_rom_data(Memory *m, const uint8_t *data, size_t size);
 uint8_t memory_read(Memory *m, uint16_t address);
 void memory_write(Memory *m, uint16_t address, uint8_t value);
 
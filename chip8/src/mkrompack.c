@@ -0,0 +1,81 @@
+// mkrompack.c
+
+/*
+Concepts:
+    Build-time generator for the embedded ROM pack (see rompack.h).
+    Usage:
+        mkrompack <out.c> <rom>...
+    Each ROM becomes a static const byte array named after its file (directory and
+    extension stripped), followed by the rompack[] table the emulator searches.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROM_MAX (4096 - 0x200)
+
+static void rom_name(const char *path, char *name, size_t cap) {
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    size_t len = strcspn(base, ".");
+    if (len >= cap) len = cap - 1;
+    memcpy(name, base, len);
+    name[len] = '\0';
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <out.c> <rom>...\n", argv[0]);
+        return 1;
+    }
+
+    FILE *out = fopen(argv[1], "w");
+    if (!out) {
+        perror("fopen output");
+        return 1;
+    }
+
+    fprintf(out, "// rompack_data.c (generated by mkrompack, do not edit)\n\n");
+    fprintf(out, "#include \"rompack.h\"\n\n");
+
+    int count = 0;
+    for (int i = 2; i < argc; ++i) {
+        FILE *f = fopen(argv[i], "rb");
+        if (!f) {
+            perror(argv[i]);
+            fclose(out);
+            return 1;
+        }
+        unsigned char buf[ROM_MAX + 1];
+        size_t n = fread(buf, 1, sizeof(buf), f);
+        fclose(f);
+        if (n == 0 || n > ROM_MAX) {
+            fprintf(stderr, "%s: ROM must be 1..%d bytes\n", argv[i], ROM_MAX);
+            fclose(out);
+            return 1;
+        }
+
+        fprintf(out, "static const uint8_t rom_%d[%zu] = {", i - 2, n);
+        for (size_t k = 0; k < n; ++k) {
+            fprintf(out, "%s0x%02x,", (k % 12) ? " " : "\n    ", buf[k]);
+        }
+        fprintf(out, "\n};\n\n");
+        count++;
+    }
+
+    fprintf(out, "const RomPackEntry rompack[] = {\n");
+    for (int i = 2; i < argc; ++i) {
+        char name[64];
+        rom_name(argv[i], name, sizeof(name));
+        fprintf(out, "    { \"%s\", rom_%d, sizeof(rom_%d) },\n", name, i - 2, i - 2);
+    }
+    if (count == 0) fprintf(out, "    { \"\", 0, 0 },\n");
+    fprintf(out, "};\n\nconst int rompack_count = %d;\n", count);
+
+    if (fclose(out) != 0) {
+        perror("fclose output");
+        return 1;
+    }
+    return 0;
+}
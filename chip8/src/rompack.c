@@ -0,0 +1,17 @@
+// rompack.c
+
+#include "rompack.h"
+#include <string.h>
+
+const RomPackEntry *rompack_find(const char *name) {
+    for (int i = 0; i < rompack_count; ++i) {
+        if (strcmp(rompack[i].name, name) == 0) return &rompack[i];
+    }
+    return NULL;
+}
+
+void rompack_list(FILE *out) {
+    for (int i = 0; i < rompack_count; ++i) {
+        fprintf(out, "  %s%-10s %5u bytes\n", ROMPACK_PREFIX, rompack[i].name, rompack[i].size);
+    }
+}
@@ -0,0 +1,33 @@
+// rompack.h
+
+/*
+Concepts:
+    ROMs compiled into the binary as linked read-only data.
+    mkrompack turns every file in ../assets into a const array in rompack_data.c at build
+    time, so loading one is a memcpy out of the executable's own pages: no open, stat or
+    read at startup. Handy when thousands of short-lived emulator processes are launched.
+    Select one with "builtin:NAME" wherever a ROM path is accepted; NAME is the asset's
+    file name without extension (builtin:PONG, builtin:bounce).
+*/
+
+#ifndef ROMPACK_H
+#define ROMPACK_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ROMPACK_PREFIX "builtin:"
+
+typedef struct {
+    const char *name;
+    const uint8_t *data;
+    uint16_t size;
+} RomPackEntry;
+
+extern const RomPackEntry rompack[];
+extern const int rompack_count;
+
+const RomPackEntry *rompack_find(const char *name);
+void rompack_list(FILE *out);
+
+#endif
@@ -0,0 +1,645 @@
+// server.c
+
+/*
+Concepts:
+    Session server: hosts many interactive CHIP-8 instances in one process.
+    Usage:
+        chip8-server [--tcp PORT] [--unix PATH] [--workers N] <rom | builtin:NAME>
+    Every connection (TCP on 127.0.0.1, or a Unix socket) gets its own instance of the ROM.
+
+    Wire protocol, deliberately tiny because the display is 1 bit deep:
+        client -> server, one byte per key event:  0x80 | key = press, key = release
+        server -> client:
+            'F' <row mask: uint32 LE> <8 bytes per set bit>   changed display rows
+                 row bytes are MSB-first (leftmost pixel in bit 7 of the first byte);
+                 the first frame of a session carries every row
+            'B' <0|1>                                          beeper turned on/off
+
+    Threads:
+        - one I/O thread waits on all sockets with epoll (poll() on systems without epoll),
+          accepts clients and queues incoming key events per session
+        - a fixed pool of workers, each owning a set of sessions, runs every session once per
+          60 Hz tick and streams back only the rows that changed
+    Why a queue and not key state? A press and release arriving within one tick would cancel
+    out. The worker applies queued events in order, stopping at the first one that would flip a
+    key already changed this tick; the rest wait for the next tick, so every tap is seen by at
+    least one frame.
+    How is FX0A handled? A session whose CPU is blocked on FX0A with no key down is parked:
+    the worker only ticks its timers until the I/O thread reports new input.
+    Reporting: every few seconds the I/O thread prints per-worker load, the measured cost of
+    one session-frame, the resulting sessions-per-core capacity at 60 Hz, and input latency
+    (key received -> frame containing its effect written to the socket). Each session prints
+    its own latency summary when it disconnects.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "chip8.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+#define CYCLES_PER_FRAME 10
+#define FRAME_NS 16666667ull
+#define OUT_BACKLOG_MAX 65536    // stop queueing frames to a client this far behind
+#define REPORT_INTERVAL_NS 5000000000ull
+#define MAX_WORKERS 64
+#define SESSION_EVENTS 256       // per-session key event queue, power of two
+
+typedef struct {
+    uint8_t code;                // wire byte: 0x80 | key = press, key = release
+    uint64_t ns;                 // arrival time
+} KeyEvent;
+
+typedef struct Session {
+    int fd;
+    int id;
+    Chip8 vm;
+
+    // Single-producer (I/O thread) / single-consumer (owning worker) key event queue
+    KeyEvent events[SESSION_EVENTS];
+    uint32_t events_head;        // written by the I/O thread
+    uint32_t events_tail;        // written by the worker
+    uint64_t events_dropped;     // I/O thread only: queue was full
+    int closing;                 // peer hung up; worker frees the session
+
+    // Worker only
+    uint64_t pending_input_ns;   // oldest applied input not yet answered, 0 = none
+    int answer_queued;           // a frame computed after that input is queued
+    int parked;
+    int dead;                    // write failed, stop sending
+    int sent_any;
+    uint8_t beep;
+    uint64_t sent_rows[DISPLAY_HEIGHT];
+    uint8_t *out;
+    size_t out_len, out_cap;
+    uint64_t frames, inputs, latency_ns_total, latency_ns_max;
+
+    struct Session *next;        // worker inbox link
+} Session;
+
+typedef struct {
+    pthread_t thread;
+    int index;
+
+    pthread_mutex_t inbox_lock;  // new sessions handed over by the I/O thread
+    Session *inbox;
+
+    Session **sessions;          // owned, worker only
+    int count, cap;
+
+    // Published for the report (relaxed atomics)
+    uint32_t live, parked;
+    uint64_t busy_ns, session_frames;
+    uint64_t latency_ns_total, latency_samples, latency_ns_max;
+} Worker;
+
+static Worker workers[MAX_WORKERS];
+static int worker_count = 1;
+static Chip8 rom_image;          // freshly initialised machine with the ROM loaded
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+static void set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/* ---- worker side ---- */
+
+static void out_append(Session *s, const void *p, size_t n) {
+    if (s->out_len + n > s->out_cap) {
+        size_t cap = s->out_cap ? s->out_cap * 2 : 1024;
+        while (cap < s->out_len + n) cap *= 2;
+        uint8_t *q = realloc(s->out, cap);
+        if (!q) return;
+        s->out = q;
+        s->out_cap = cap;
+    }
+    memcpy(s->out + s->out_len, p, n);
+    s->out_len += n;
+}
+
+static void out_flush(Session *s) {
+    size_t off = 0;
+    while (off < s->out_len) {
+        ssize_t w = write(s->fd, s->out + off, s->out_len - off);
+        if (w > 0) {
+            off += (size_t)w;
+        } else if (w < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (w < 0 && errno != EAGAIN && errno != EWOULDBLOCK) s->dead = 1;
+            break;
+        }
+    }
+    memmove(s->out, s->out + off, s->out_len - off);
+    s->out_len -= off;
+}
+
+static uint64_t pack_row(const uint8_t *px) {
+    uint64_t row = 0;
+    for (int x = 0; x < DISPLAY_WIDTH; ++x) row = (row << 1) | (px[x] & 1);
+    return row;
+}
+
+// Queue the rows that changed since the last queued frame; returns 1 if anything was queued
+static int session_queue_frame(Session *s) {
+    uint8_t msg[1 + 4 + DISPLAY_HEIGHT * 8];
+    uint32_t mask = 0;
+    size_t len = 5;
+
+    for (int y = 0; y < DISPLAY_HEIGHT; ++y) {
+        uint64_t row = pack_row(&s->vm.gfx[y * DISPLAY_WIDTH]);
+        if (s->sent_any && row == s->sent_rows[y]) continue;
+        s->sent_rows[y] = row;
+        mask |= 1u << y;
+        for (int b = 0; b < 8; ++b) msg[len++] = (uint8_t)(row >> (56 - 8 * b));
+    }
+    s->sent_any = 1;
+    if (!mask) return 0;
+
+    msg[0] = 'F';
+    msg[1] = (uint8_t)mask;
+    msg[2] = (uint8_t)(mask >> 8);
+    msg[3] = (uint8_t)(mask >> 16);
+    msg[4] = (uint8_t)(mask >> 24);
+    out_append(s, msg, len);
+    return 1;
+}
+
+static void session_free(Session *s) {
+    if (s->frames > 0) {
+        uint64_t samples = s->inputs;
+        fprintf(stderr, "session %d closed: %llu frames, %llu inputs answered, latency avg %.2f ms max %.2f ms\n",
+                s->id, (unsigned long long)s->frames, (unsigned long long)samples,
+                samples ? s->latency_ns_total / 1e6 / (double)samples : 0.0,
+                s->latency_ns_max / 1e6);
+    }
+    if (s->events_dropped) {
+        fprintf(stderr, "session %d: %llu key events dropped (queue full)\n",
+                s->id, (unsigned long long)s->events_dropped);
+    }
+    close(s->fd);
+    free(s->out);
+    free(s);
+}
+
+// Run one 60 Hz tick of a session
+static void session_tick(Worker *w, Session *s) {
+    // Apply queued key events in order; a second change to the same key waits a tick
+    uint32_t head = __atomic_load_n(&s->events_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = s->events_tail;
+    uint16_t changed = 0;
+    if (tail != head) {
+        if (!s->pending_input_ns) s->pending_input_ns = s->events[tail & (SESSION_EVENTS - 1)].ns;
+        s->parked = 0;
+    }
+    while (tail != head) {
+        const KeyEvent *e = &s->events[tail & (SESSION_EVENTS - 1)];
+        uint8_t key = e->code & 0x0F;
+        if (changed & (1u << key)) break;
+        changed |= (uint16_t)(1u << key);
+        chip8_set_key(&s->vm, key, e->code >> 7);
+        tail++;
+    }
+    __atomic_store_n(&s->events_tail, tail, __ATOMIC_RELEASE);
+
+    if (!s->parked) {
+        chip8_run_frame(&s->vm, CYCLES_PER_FRAME);
+        if (chip8_waiting_for_key(&s->vm)) s->parked = 1;
+    }
+
+    uint8_t beep = s->vm.cpu.sound_timer > 0;
+    chip8_tick_timers(&s->vm);
+    s->frames++;
+    if (s->dead) return;
+
+    if (beep != s->beep) {
+        uint8_t msg[2] = { 'B', beep };
+        out_append(s, msg, sizeof(msg));
+        s->beep = beep;
+    }
+    if ((s->vm.draw_flag || !s->sent_any) && s->out_len < OUT_BACKLOG_MAX) {
+        if (session_queue_frame(s) && s->pending_input_ns) s->answer_queued = 1;
+        s->vm.draw_flag = 0;
+    }
+    if (s->out_len) out_flush(s);
+
+    // The input has been answered once a frame computed after it is on the wire; an input
+    // with no visible effect stays pending until something is drawn
+    if (s->answer_queued && s->out_len == 0) {
+        uint64_t lat = now_ns() - s->pending_input_ns;
+        s->latency_ns_total += lat;
+        if (lat > s->latency_ns_max) s->latency_ns_max = lat;
+        s->inputs++;
+        s->pending_input_ns = 0;
+        s->answer_queued = 0;
+        __atomic_fetch_add(&w->latency_ns_total, lat, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&w->latency_samples, 1, __ATOMIC_RELAXED);
+        if (lat > __atomic_load_n(&w->latency_ns_max, __ATOMIC_RELAXED))
+            __atomic_store_n(&w->latency_ns_max, lat, __ATOMIC_RELAXED);
+    }
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    uint64_t next_tick = now_ns();
+
+    for (;;) {
+        // Adopt sessions handed over by the I/O thread
+        pthread_mutex_lock(&w->inbox_lock);
+        Session *incoming = w->inbox;
+        w->inbox = NULL;
+        pthread_mutex_unlock(&w->inbox_lock);
+        while (incoming) {
+            Session *s = incoming;
+            incoming = s->next;
+            if (w->count == w->cap) {
+                int cap = w->cap ? w->cap * 2 : 16;
+                Session **p = realloc(w->sessions, (size_t)cap * sizeof(*p));
+                if (!p) {
+                    session_free(s);
+                    continue;
+                }
+                w->sessions = p;
+                w->cap = cap;
+            }
+            w->sessions[w->count++] = s;
+        }
+
+        uint64_t start = now_ns();
+        uint32_t parked = 0;
+        for (int i = 0; i < w->count; ) {
+            Session *s = w->sessions[i];
+            if (__atomic_load_n(&s->closing, __ATOMIC_ACQUIRE)) {
+                session_free(s);
+                w->sessions[i] = w->sessions[--w->count];
+                continue;
+            }
+            session_tick(w, s);
+            parked += (uint32_t)s->parked;
+            ++i;
+        }
+        uint64_t end = now_ns();
+
+        __atomic_store_n(&w->live, (uint32_t)w->count, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->parked, parked, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&w->busy_ns, end - start, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&w->session_frames, (uint64_t)w->count, __ATOMIC_RELAXED);
+
+        // Sleep to the next tick; if we overran, skip ahead rather than bursting
+        next_tick += FRAME_NS;
+        if (end >= next_tick) {
+            next_tick = end;
+        } else {
+            uint64_t left = next_tick - end;
+            struct timespec ts = { (time_t)(left / 1000000000ull), (long)(left % 1000000000ull) };
+            nanosleep(&ts, NULL);
+        }
+    }
+    return NULL;
+}
+
+/* ---- I/O thread ---- */
+
+#ifdef __linux__
+typedef struct { int fd; } EventLoop;
+
+static int ev_init(EventLoop *ev) {
+    ev->fd = epoll_create1(0);
+    return ev->fd < 0 ? -1 : 0;
+}
+
+static void ev_add(EventLoop *ev, int fd, void *data) {
+    struct epoll_event e;
+    memset(&e, 0, sizeof(e));
+    e.events = EPOLLIN | EPOLLRDHUP;
+    e.data.ptr = data;
+    epoll_ctl(ev->fd, EPOLL_CTL_ADD, fd, &e);
+}
+
+static void ev_del(EventLoop *ev, int fd) {
+    epoll_ctl(ev->fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+static int ev_wait(EventLoop *ev, void **ready, int max, int timeout_ms) {
+    struct epoll_event events[64];
+    if (max > 64) max = 64;
+    int n = epoll_wait(ev->fd, events, max, timeout_ms);
+    for (int i = 0; i < n; ++i) ready[i] = events[i].data.ptr;
+    return n < 0 ? 0 : n;
+}
+#else
+// poll() stand-in with the same interface for platforms without epoll
+typedef struct {
+    struct pollfd *fds;
+    void **data;
+    int count, cap;
+} EventLoop;
+
+static int ev_init(EventLoop *ev) {
+    memset(ev, 0, sizeof(*ev));
+    return 0;
+}
+
+static void ev_add(EventLoop *ev, int fd, void *data) {
+    if (ev->count == ev->cap) {
+        int cap = ev->cap ? ev->cap * 2 : 64;
+        struct pollfd *f = realloc(ev->fds, (size_t)cap * sizeof(*f));
+        if (!f) return;
+        ev->fds = f;
+        void **d = realloc(ev->data, (size_t)cap * sizeof(*d));
+        if (!d) return;
+        ev->data = d;
+        ev->cap = cap;
+    }
+    ev->fds[ev->count].fd = fd;
+    ev->fds[ev->count].events = POLLIN;
+    ev->fds[ev->count].revents = 0;
+    ev->data[ev->count++] = data;
+}
+
+static void ev_del(EventLoop *ev, int fd) {
+    for (int i = 0; i < ev->count; ++i) {
+        if (ev->fds[i].fd == fd) {
+            ev->fds[i] = ev->fds[--ev->count];
+            ev->data[i] = ev->data[ev->count];
+            return;
+        }
+    }
+}
+
+static int ev_wait(EventLoop *ev, void **ready, int max, int timeout_ms) {
+    if (poll(ev->fds, (nfds_t)ev->count, timeout_ms) <= 0) return 0;
+    int n = 0;
+    for (int i = 0; i < ev->count && n < max; ++i) {
+        if (ev->fds[i].revents) ready[n++] = ev->data[i];
+    }
+    return n;
+}
+#endif
+
+// Listener entries in the event loop are tagged by pointing at these
+static int tcp_listener = -1, unix_listener = -1;
+
+static int listen_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+        perror("bind/listen tcp");
+        close(fd);
+        return -1;
+    }
+    set_nonblocking(fd);
+    return fd;
+}
+
+static int listen_unix(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        close(fd);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+        perror("bind/listen unix");
+        close(fd);
+        return -1;
+    }
+    set_nonblocking(fd);
+    return fd;
+}
+
+static void accept_clients(EventLoop *ev, int lfd, int tcp) {
+    static int next_id = 1;
+    for (;;) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) return;
+        set_nonblocking(fd);
+        if (tcp) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        Session *s = calloc(1, sizeof(Session));
+        if (!s) {
+            close(fd);
+            continue;
+        }
+        s->fd = fd;
+        s->id = next_id++;
+        chip8_snapshot(&rom_image, &s->vm);
+        s->vm.draw_flag = 1;
+
+        // Hand to the least loaded worker
+        Worker *w = &workers[0];
+        for (int i = 1; i < worker_count; ++i) {
+            if (__atomic_load_n(&workers[i].live, __ATOMIC_RELAXED) <
+                __atomic_load_n(&w->live, __ATOMIC_RELAXED)) w = &workers[i];
+        }
+        __atomic_fetch_add(&w->live, 1, __ATOMIC_RELAXED); // until the worker republishes
+
+        ev_add(ev, fd, s);
+        pthread_mutex_lock(&w->inbox_lock);
+        s->next = w->inbox;
+        w->inbox = s;
+        pthread_mutex_unlock(&w->inbox_lock);
+    }
+}
+
+static void read_client(EventLoop *ev, Session *s) {
+    uint8_t buf[256];
+    for (;;) {
+        ssize_t n = read(s->fd, buf, sizeof(buf));
+        if (n > 0) {
+            uint64_t t = now_ns();
+            uint32_t head = s->events_head;
+            uint32_t tail = __atomic_load_n(&s->events_tail, __ATOMIC_ACQUIRE);
+            for (ssize_t i = 0; i < n; ++i) {
+                // A client this far ahead of the 60 Hz tick is flooding; drop and count
+                if (head - tail >= SESSION_EVENTS) {
+                    s->events_dropped++;
+                    continue;
+                }
+                KeyEvent *e = &s->events[head & (SESSION_EVENTS - 1)];
+                e->code = buf[i] & 0x8F;
+                e->ns = t;
+                head++;
+            }
+            __atomic_store_n(&s->events_head, head, __ATOMIC_RELEASE);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+        // EOF or error: stop watching, the owning worker frees the session
+        ev_del(ev, s->fd);
+        __atomic_store_n(&s->closing, 1, __ATOMIC_RELEASE);
+        return;
+    }
+}
+
+static void report(uint64_t elapsed_ns) {
+    uint32_t live = 0, parked = 0;
+    uint64_t busy = 0, frames = 0, lat_total = 0, lat_samples = 0, lat_max = 0;
+
+    fprintf(stderr, "--- %d worker(s)\n", worker_count);
+    for (int i = 0; i < worker_count; ++i) {
+        Worker *w = &workers[i];
+        uint64_t b = __atomic_exchange_n(&w->busy_ns, 0, __ATOMIC_RELAXED);
+        uint32_t l = __atomic_load_n(&w->live, __ATOMIC_RELAXED);
+        fprintf(stderr, "worker %d: %u sessions, %.1f%% busy\n", i, l, 100.0 * b / (double)elapsed_ns);
+        live += l;
+        parked += __atomic_load_n(&w->parked, __ATOMIC_RELAXED);
+        busy += b;
+        frames += __atomic_exchange_n(&w->session_frames, 0, __ATOMIC_RELAXED);
+        lat_total += __atomic_exchange_n(&w->latency_ns_total, 0, __ATOMIC_RELAXED);
+        lat_samples += __atomic_exchange_n(&w->latency_samples, 0, __ATOMIC_RELAXED);
+        uint64_t m = __atomic_exchange_n(&w->latency_ns_max, 0, __ATOMIC_RELAXED);
+        if (m > lat_max) lat_max = m;
+    }
+
+    fprintf(stderr, "sessions %u (%u parked on FX0A)", live, parked);
+    if (frames > 0) {
+        double cost_ns = busy / (double)frames;
+        fprintf(stderr, ", %.2f us per session-frame, capacity ~%.0f sessions/core at 60 Hz",
+                cost_ns / 1e3, FRAME_NS / cost_ns);
+    }
+    if (lat_samples > 0) {
+        fprintf(stderr, ", input latency avg %.2f ms max %.2f ms",
+                lat_total / 1e6 / (double)lat_samples, lat_max / 1e6);
+    }
+    fputc('\n', stderr);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--tcp PORT] [--unix PATH] [--workers N] <rom | builtin:NAME>\n", prog);
+    fprintf(stderr, "  --tcp PORT     listen on 127.0.0.1:PORT (default 7800 if no --unix)\n");
+    fprintf(stderr, "  --unix PATH    listen on a Unix socket\n");
+    fprintf(stderr, "  --workers N    emulation worker threads (default: online CPUs)\n");
+}
+
+int main(int argc, char **argv) {
+    const char *rom = NULL;
+    const char *unix_path = NULL;
+    int tcp_port = 0;
+
+#ifdef _SC_NPROCESSORS_ONLN
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0) worker_count = cpus > MAX_WORKERS ? MAX_WORKERS : (int)cpus;
+#endif
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--tcp") == 0 && i + 1 < argc) {
+            tcp_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+            unix_path = argv[++i];
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            worker_count = atoi(argv[++i]);
+            if (worker_count < 1 || worker_count > MAX_WORKERS) {
+                fprintf(stderr, "--workers must be between 1 and %d\n", MAX_WORKERS);
+                return 1;
+            }
+        } else if (argv[i][0] == '-' || rom) {
+            usage(argv[0]);
+            return 1;
+        } else {
+            rom = argv[i];
+        }
+    }
+    if (!rom) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!tcp_port && !unix_path) tcp_port = 7800;
+
+    chip8_init(&rom_image);
+    chip8_load_rom(&rom_image, rom);
+    signal(SIGPIPE, SIG_IGN);
+
+    EventLoop ev;
+    if (ev_init(&ev) != 0) {
+        perror("event loop");
+        return 1;
+    }
+    if (tcp_port) {
+        tcp_listener = listen_tcp(tcp_port);
+        if (tcp_listener < 0) return 1;
+        ev_add(&ev, tcp_listener, &tcp_listener);
+        fprintf(stderr, "Listening on 127.0.0.1:%d\n", tcp_port);
+    }
+    if (unix_path) {
+        unix_listener = listen_unix(unix_path);
+        if (unix_listener < 0) return 1;
+        ev_add(&ev, unix_listener, &unix_listener);
+        fprintf(stderr, "Listening on %s\n", unix_path);
+    }
+
+    for (int i = 0; i < worker_count; ++i) {
+        workers[i].index = i;
+        pthread_mutex_init(&workers[i].inbox_lock, NULL);
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+            fprintf(stderr, "Failed to start worker %d\n", i);
+            return 1;
+        }
+    }
+
+    uint64_t last_report = now_ns();
+    for (;;) {
+        void *ready[64];
+        int n = ev_wait(&ev, ready, 64, 1000);
+        for (int i = 0; i < n; ++i) {
+            if (ready[i] == &tcp_listener) accept_clients(&ev, tcp_listener, 1);
+            else if (ready[i] == &unix_listener) accept_clients(&ev, unix_listener, 0);
+            else read_client(&ev, ready[i]);
+        }
+
+        uint64_t t = now_ns();
+        if (t - last_report >= REPORT_INTERVAL_NS) {
+            report(t - last_report);
+            last_report = t;
+        }
+    }
+}
@@ -6,35 +6,54 @@
 
 static SDL_AudioDeviceID audio_device = 0;
 static uint8_t is_playing = 0;
+static uint8_t enabled = 0;   // sound_init called; device not opened until the first beep
+static int beep_samples = 0;  // tone still owed to the callback, shared with the audio thread
+
+#define SOUND_SAMPLE_RATE 44100
+#define SOUND_MIN_BEEP (SOUND_SAMPLE_RATE / 60) // one timer tick
 
 // Audio callback function
 void audio_callback(void *userdata, uint8_t *stream, int len) {
     (void)userdata;
     static float phase = 0.0f;
     const float frequency = 440.0f; // A note
-    const float sample_rate = 44100.0f;
+    const float sample_rate = (float)SOUND_SAMPLE_RATE;
     const float amplitude = 0.1f; // Volume (0.0 to 1.0)
     
     int16_t *buffer = (int16_t*)stream;
     int samples = len / 2;
     
+    const int latched = __atomic_load_n(&beep_samples, __ATOMIC_ACQUIRE);
+    int owed = latched;
     for (int i = 0; i < samples; i++) {
-        if (is_playing) {
+        if (is_playing || owed > 0) {
             float sample = amplitude * sinf(phase * 2.0f * M_PI);
             buffer[i] = (int16_t)(sample * 32767.0f);
             phase += frequency / sample_rate;
             if (phase >= 1.0f) phase -= 1.0f;
+            if (owed > 0) owed--;
         } else {
             buffer[i] = 0;
         }
     }
+    // Subtract only what was played, so a refill from sound_play_beep meanwhile is kept
+    if (latched > owed) __atomic_sub_fetch(&beep_samples, latched - owed, __ATOMIC_ACQ_REL);
 }
 
-void sound_init(void) {
+// Opening an audio device costs tens of milliseconds and many ROMs never beep, so the
+// subsystem and device are brought up when the sound timer is first set. SDL's audio setup
+// touches global state that isn't safe to share with other threads, so this runs on the
+// main thread from the frame loop: a one-off stall on the first beep instead of at startup.
+static int sound_open(void) {
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        fprintf(stderr, "Failed to init audio: %s\n", SDL_GetError());
+        return -1;
+    }
+
     SDL_AudioSpec want, have;
     SDL_memset(&want, 0, sizeof(want));
     
-    want.freq = 44100;
+    want.freq = SOUND_SAMPLE_RATE;
     want.format = AUDIO_S16SYS;
     want.channels = 1;
     want.samples = 2048;
@@ -43,13 +62,26 @@ void sound_init(void) {
     audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
     if (audio_device == 0) {
         fprintf(stderr, "Failed to open audio: %s\n", SDL_GetError());
-        return;
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return -1;
     }
     
     SDL_PauseAudioDevice(audio_device, 0); // Start audio
+    return 0;
+}
+
+void sound_init(void) {
+    enabled = 1;
 }
 
 void sound_play_beep(void) {
+    // Opened at most once; a device that failed to open is not retried every frame
+    if (enabled && audio_device == 0 && sound_open() != 0) enabled = 0;
+
+    // Latch at least one tick of tone: a beep that starts and stops before the callback
+    // first runs (the device has only just started) is still heard
+    int owed = __atomic_load_n(&beep_samples, __ATOMIC_ACQUIRE);
+    if (owed < SOUND_MIN_BEEP) __atomic_add_fetch(&beep_samples, SOUND_MIN_BEEP - owed, __ATOMIC_ACQ_REL);
     is_playing = 1;
 }
 
@@ -60,6 +92,8 @@ void sound_stop_beep(void) {
 void sound_cleanup(void) {
     if (audio_device != 0) {
         SDL_CloseAudioDevice(audio_device);
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
         audio_device = 0;
     }
-}
\ No newline at end of file
+    enabled = 0;
+}
@@ -0,0 +1,189 @@
+// stats.c
+
+/*
+Concepts:
+    Implementation of stats.h for the CHIP-8 emulator.
+    How is the page created? shm_open + ftruncate + mmap; ftruncate zero-fills, so the first
+    process to see magic == 0 stamps the header. A page with another magic or version (left by
+    an older build with a different layout) is rejected rather than misread.
+    How is a slot claimed? Compare-and-swap the slot's pid from 0 (or from a dead process) to ours.
+    How do readers get a consistent view without locks? The seqlock: read seq, copy, read seq
+    again, retry if it changed or was odd.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static StatsPage *stats_map(int writable) {
+    int fd = shm_open(STATS_SHM_NAME, writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+    if (fd < 0) {
+        if (writable) perror("shm_open stats");
+        return NULL;
+    }
+
+    struct stat st;
+    if (writable) {
+        if (fstat(fd, &st) == 0 && st.st_size < (off_t)sizeof(StatsPage) &&
+            ftruncate(fd, sizeof(StatsPage)) != 0) {
+            perror("ftruncate stats");
+            close(fd);
+            return NULL;
+        }
+    } else if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(StatsPage)) {
+        // Smaller than our layout: reading past the end would fault
+        fprintf(stderr, "stats: %s has an unknown layout\n", STATS_SHM_NAME);
+        close(fd);
+        return NULL;
+    }
+
+    void *p = mmap(NULL, sizeof(StatsPage), writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap stats");
+        return NULL;
+    }
+    return (StatsPage *)p;
+}
+
+static int pid_alive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+int stats_open(Stats *s, const char *rom) {
+    memset(s, 0, sizeof(*s));
+    StatsPage *page = stats_map(1);
+    if (!page) return -1;
+
+    // Stamp the version before the magic so no opener ever sees our magic with version 0;
+    // a page that already has a version keeps it and is checked below
+    uint32_t expected = 0;
+    __atomic_compare_exchange_n(&page->version, &expected, STATS_VERSION, 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    expected = 0;
+    if (__atomic_compare_exchange_n(&page->magic, &expected, STATS_MAGIC, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        page->max_instances = STATS_MAX_INSTANCES;
+    }
+    if (expected != 0 && expected != STATS_MAGIC) {
+        fprintf(stderr, "stats: %s has an unknown layout\n", STATS_SHM_NAME);
+        munmap(page, sizeof(StatsPage));
+        return -1;
+    }
+    if (__atomic_load_n(&page->version, __ATOMIC_ACQUIRE) != STATS_VERSION) {
+        fprintf(stderr, "stats: %s is layout version %u, expected %u\n", STATS_SHM_NAME,
+                __atomic_load_n(&page->version, __ATOMIC_RELAXED), STATS_VERSION);
+        munmap(page, sizeof(StatsPage));
+        return -1;
+    }
+
+    int32_t self = (int32_t)getpid();
+    for (int i = 0; i < STATS_MAX_INSTANCES; ++i) {
+        StatsSlot *slot = &page->slots[i];
+        int32_t owner = __atomic_load_n(&slot->pid, __ATOMIC_ACQUIRE);
+        if (owner != 0 && pid_alive(owner)) continue;
+        if (!__atomic_compare_exchange_n(&slot->pid, &owner, self, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) continue;
+
+        // Slot is ours; reset it under the seqlock so readers never see a half-cleared slot
+        uint32_t seq = slot->seq;
+        __atomic_store_n(&slot->seq, seq | 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memset(&slot->total, 0, sizeof(slot->total));
+        slot->ips = slot->last_frame_ns = slot->last_render_ns = slot->last_sleep_overshoot_ns = 0;
+        memset(slot->rom, 0, sizeof(slot->rom));
+        if (rom) {
+            const char *base = strrchr(rom, '/');
+            strncpy(slot->rom, base ? base + 1 : rom, sizeof(slot->rom) - 1);
+        }
+        __atomic_store_n(&slot->seq, (seq | 1) + 1, __ATOMIC_RELEASE);
+
+        s->page = page;
+        s->slot = slot;
+        return 0;
+    }
+
+    fprintf(stderr, "stats: all %d slots in use\n", STATS_MAX_INSTANCES);
+    munmap(page, sizeof(StatsPage));
+    return -1;
+}
+
+void stats_publish(Stats *s, const StatsFrame *f, uint64_t now_ns) {
+    StatsSlot *slot = s->slot;
+    if (!slot) return;
+
+    if (s->window_start_ns == 0) s->window_start_ns = now_ns;
+    s->window_instructions += f->instructions;
+
+    uint32_t seq = slot->seq;
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->total.instructions += f->instructions;
+    slot->total.frames++;
+    slot->total.frames_dropped += f->dropped;
+    slot->total.renders += f->rendered;
+    slot->total.frame_ns += f->frame_ns;
+    slot->total.render_ns += f->render_ns;
+    slot->total.sleep_overshoot_ns += f->sleep_overshoot_ns;
+    slot->last_frame_ns = f->frame_ns;
+    slot->last_render_ns = f->render_ns;
+    slot->last_sleep_overshoot_ns = f->sleep_overshoot_ns;
+
+    uint64_t window = now_ns - s->window_start_ns;
+    if (window >= 1000000000ull) {
+        slot->ips = s->window_instructions * 1000000000ull / window;
+        s->window_start_ns = now_ns;
+        s->window_instructions = 0;
+    }
+
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+
+    StatsCounters *agg = &s->page->aggregate;
+    __atomic_fetch_add(&agg->instructions, f->instructions, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&agg->frames, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&agg->frames_dropped, f->dropped, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&agg->renders, f->rendered, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&agg->frame_ns, f->frame_ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&agg->render_ns, f->render_ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&agg->sleep_overshoot_ns, f->sleep_overshoot_ns, __ATOMIC_RELAXED);
+}
+
+void stats_close(Stats *s) {
+    if (s->slot) __atomic_store_n(&s->slot->pid, 0, __ATOMIC_RELEASE);
+    if (s->page) munmap(s->page, sizeof(StatsPage));
+    memset(s, 0, sizeof(*s));
+}
+
+const StatsPage *stats_map_readonly(void) {
+    const StatsPage *page = stats_map(0);
+    if (page && (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != STATS_MAGIC ||
+                 __atomic_load_n(&page->version, __ATOMIC_ACQUIRE) != STATS_VERSION)) {
+        fprintf(stderr, "stats: %s has an unknown layout\n", STATS_SHM_NAME);
+        munmap((void *)page, sizeof(StatsPage));
+        return NULL;
+    }
+    return page;
+}
+
+int stats_read_slot(const StatsSlot *slot, StatsSlot *out) {
+    for (int tries = 0; tries < 1000; ++tries) {
+        uint32_t before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) continue;
+        memcpy(out, slot, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == before) {
+            return out->pid != 0 && pid_alive(out->pid);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+// stats.h
+
+/*
+Concepts:
+    Live metrics for running emulators, published through a POSIX shared-memory page.
+    Every emulator process claims one slot in the page and updates its counters once per frame.
+    Writers never make a syscall after setup: updates are plain stores guarded by a seqlock
+    (an odd sequence number means "update in progress, read again").
+    Aggregate counters across all instances are kept with atomic adds.
+    External readers (see stats_export.c) map the same page read-only and poll it.
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+#define STATS_SHM_NAME "/chip8-stats"
+#define STATS_MAGIC 0x43385354u // "C8ST"
+#define STATS_VERSION 1
+#define STATS_MAX_INSTANCES 64
+#define STATS_ROM_NAME_LEN 48
+
+typedef struct {
+    uint64_t instructions;         // CPU cycles executed
+    uint64_t frames;               // 60 Hz frames run
+    uint64_t frames_dropped;       // frames that overran the frame budget
+    uint64_t renders;              // frames presented to the display
+    uint64_t frame_ns;             // time spent emulating + rendering
+    uint64_t render_ns;            // time spent rendering
+    uint64_t sleep_overshoot_ns;   // time slept past the requested wake-up
+} StatsCounters;
+
+typedef struct {
+    uint32_t seq;                  // seqlock sequence, odd while updating
+    int32_t pid;                   // owning process, 0 = free slot
+    char rom[STATS_ROM_NAME_LEN];  // ROM being run
+    StatsCounters total;           // monotonic counters
+    uint64_t ips;                  // instructions over the last second
+    uint64_t last_frame_ns;        // most recent frame time
+    uint64_t last_render_ns;       // most recent render time
+    uint64_t last_sleep_overshoot_ns;
+} __attribute__((aligned(64))) StatsSlot;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t max_instances;
+    uint32_t reserved;
+    StatsCounters aggregate;       // sum over every instance that ever ran
+    StatsSlot slots[STATS_MAX_INSTANCES];
+} StatsPage;
+
+// One frame's worth of measurements, handed to stats_publish by the runner.
+typedef struct {
+    uint32_t instructions;
+    uint8_t dropped;
+    uint8_t rendered;
+    uint64_t frame_ns;
+    uint64_t render_ns;
+    uint64_t sleep_overshoot_ns;
+} StatsFrame;
+
+typedef struct {
+    StatsPage *page;
+    StatsSlot *slot;
+    uint64_t window_start_ns;      // start of the current IPS window
+    uint64_t window_instructions;
+} Stats;
+
+// Writer side (emulator)
+int stats_open(Stats *s, const char *rom);
+void stats_publish(Stats *s, const StatsFrame *f, uint64_t now_ns);
+void stats_close(Stats *s);
+
+// Reader side (exporter)
+const StatsPage *stats_map_readonly(void);
+int stats_read_slot(const StatsSlot *slot, StatsSlot *out);
+
+#endif
@@ -0,0 +1,237 @@
+// stats_export.c
+
+/*
+Concepts:
+    Companion tool that reads the shared-memory stats page (stats.h) and prints it in
+    Prometheus text exposition format.
+    Usage:
+        chip8-stats                 print one scrape to stdout
+        chip8-stats -l <socket>     serve scrapes on a Unix socket, one per connection
+    The socket speaks just enough HTTP for Prometheus / curl --unix-socket; a client that
+    does not send an HTTP request line gets the bare text.
+    All the work happens here, so the emulator side stays syscall-free.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+} Text;
+
+__attribute__((format(printf, 2, 3)))
+static void text_printf(Text *t, const char *fmt, ...) {
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(t->buf + t->len, t->cap - t->len, fmt, ap);
+        va_end(ap);
+        if (n < 0) return;
+        if (t->len + (size_t)n < t->cap) {
+            t->len += (size_t)n;
+            return;
+        }
+        size_t cap = t->cap ? t->cap * 2 : 4096;
+        while (cap <= t->len + (size_t)n) cap *= 2;
+        char *p = realloc(t->buf, cap);
+        if (!p) return;
+        t->buf = p;
+        t->cap = cap;
+    }
+}
+
+static void metric_header(Text *t, const char *name, const char *type, const char *help) {
+    text_printf(t, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Label values escape backslash, double quote and newline (text exposition format)
+static void escape_label(const char *in, size_t in_len, char *out) {
+    for (size_t i = 0; i < in_len && in[i]; ++i) {
+        if (in[i] == '\\' || in[i] == '"') {
+            *out++ = '\\';
+            *out++ = in[i];
+        } else if (in[i] == '\n') {
+            *out++ = '\\';
+            *out++ = 'n';
+        } else {
+            *out++ = in[i];
+        }
+    }
+    *out = '\0';
+}
+
+static void render_metrics(const StatsPage *page, Text *t) {
+    StatsSlot live[STATS_MAX_INSTANCES];
+    int n = 0;
+    for (int i = 0; i < STATS_MAX_INSTANCES; ++i) {
+        if (stats_read_slot(&page->slots[i], &live[n])) n++;
+    }
+
+    // Every byte escapes to at most two, plus the terminator
+    char rom[STATS_MAX_INSTANCES][STATS_ROM_NAME_LEN * 2 + 1];
+    for (int i = 0; i < n; ++i) escape_label(live[i].rom, sizeof(live[i].rom), rom[i]);
+
+    metric_header(t, "chip8_instances", "gauge", "Running emulator instances.");
+    text_printf(t, "chip8_instances %d\n", n);
+
+    // Per-instance counters: name, help, field offset, scale (ns -> s)
+    static const struct {
+        const char *name;
+        const char *help;
+        size_t offset;
+        int seconds;
+    } counters[] = {
+        { "chip8_instructions_total", "CPU cycles executed.", offsetof(StatsCounters, instructions), 0 },
+        { "chip8_frames_total", "Frames run.", offsetof(StatsCounters, frames), 0 },
+        { "chip8_frames_dropped_total", "Frames that overran the 60 Hz budget.", offsetof(StatsCounters, frames_dropped), 0 },
+        { "chip8_renders_total", "Frames presented.", offsetof(StatsCounters, renders), 0 },
+        { "chip8_frame_seconds_total", "Time spent emulating and rendering.", offsetof(StatsCounters, frame_ns), 1 },
+        { "chip8_render_seconds_total", "Time spent rendering.", offsetof(StatsCounters, render_ns), 1 },
+        { "chip8_sleep_overshoot_seconds_total", "Time slept past the requested wake-up.", offsetof(StatsCounters, sleep_overshoot_ns), 1 },
+    };
+
+    for (size_t m = 0; m < sizeof(counters) / sizeof(counters[0]); ++m) {
+        metric_header(t, counters[m].name, "counter", counters[m].help);
+        for (int i = 0; i < n; ++i) {
+            uint64_t v;
+            memcpy(&v, (const char *)&live[i].total + counters[m].offset, sizeof(v));
+            text_printf(t, "%s{pid=\"%d\",rom=\"%s\"} ", counters[m].name, live[i].pid, rom[i]);
+            if (counters[m].seconds) text_printf(t, "%.9f\n", v / 1e9);
+            else text_printf(t, "%llu\n", (unsigned long long)v);
+        }
+    }
+
+    metric_header(t, "chip8_ips", "gauge", "Instructions per second over the last second.");
+    for (int i = 0; i < n; ++i)
+        text_printf(t, "chip8_ips{pid=\"%d\",rom=\"%s\"} %llu\n", live[i].pid, rom[i],
+                    (unsigned long long)live[i].ips);
+    metric_header(t, "chip8_last_frame_seconds", "gauge", "Most recent frame time.");
+    for (int i = 0; i < n; ++i)
+        text_printf(t, "chip8_last_frame_seconds{pid=\"%d\",rom=\"%s\"} %.9f\n", live[i].pid,
+                    rom[i], live[i].last_frame_ns / 1e9);
+    metric_header(t, "chip8_last_render_seconds", "gauge", "Most recent render time.");
+    for (int i = 0; i < n; ++i)
+        text_printf(t, "chip8_last_render_seconds{pid=\"%d\",rom=\"%s\"} %.9f\n", live[i].pid,
+                    rom[i], live[i].last_render_ns / 1e9);
+    metric_header(t, "chip8_last_sleep_overshoot_seconds", "gauge", "Most recent sleep overshoot.");
+    for (int i = 0; i < n; ++i)
+        text_printf(t, "chip8_last_sleep_overshoot_seconds{pid=\"%d\",rom=\"%s\"} %.9f\n",
+                    live[i].pid, rom[i], live[i].last_sleep_overshoot_ns / 1e9);
+
+    // Aggregates over every instance that has run since the page was created
+    for (size_t m = 0; m < sizeof(counters) / sizeof(counters[0]); ++m) {
+        uint64_t v = __atomic_load_n((const uint64_t *)((const char *)&page->aggregate + counters[m].offset),
+                                     __ATOMIC_RELAXED);
+        char name[96];
+        snprintf(name, sizeof(name), "chip8_all_%s", counters[m].name + strlen("chip8_"));
+        metric_header(t, name, "counter", counters[m].help);
+        if (counters[m].seconds) text_printf(t, "%s %.9f\n", name, v / 1e9);
+        else text_printf(t, "%s %llu\n", name, (unsigned long long)v);
+    }
+}
+
+static void write_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, p, len);
+        if (w <= 0) return;
+        p += w;
+        len -= (size_t)w;
+    }
+}
+
+static void serve_client(const StatsPage *page, int fd) {
+    // Give an HTTP client a moment to send its request line, but never wait on a bare reader
+    char req[1024];
+    ssize_t r = 0;
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 100) > 0) r = read(fd, req, sizeof(req) - 1);
+    int http = r >= 4 && memcmp(req, "GET ", 4) == 0;
+
+    Text body = { 0 };
+    render_metrics(page, &body);
+
+    if (http) {
+        char header[160];
+        int n = snprintf(header, sizeof(header),
+                         "HTTP/1.0 200 OK\r\n"
+                         "Content-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: %zu\r\n\r\n", body.len);
+        write_all(fd, header, (size_t)n);
+    }
+    write_all(fd, body.buf, body.len);
+    free(body.buf);
+}
+
+static int listen_unix(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        close(fd);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    const char *sock_path = NULL;
+    if (argc == 3 && strcmp(argv[1], "-l") == 0) {
+        sock_path = argv[2];
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [-l <unix-socket>]\n", argv[0]);
+        return 1;
+    }
+
+    const StatsPage *page = stats_map_readonly();
+    if (!page) {
+        fprintf(stderr, "No stats page at %s (is an emulator running with --stats?)\n", STATS_SHM_NAME);
+        return 1;
+    }
+
+    if (!sock_path) {
+        Text t = { 0 };
+        render_metrics(page, &t);
+        fwrite(t.buf, 1, t.len, stdout);
+        free(t.buf);
+        return 0;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    int lfd = listen_unix(sock_path);
+    if (lfd < 0) return 1;
+
+    for (;;) {
+        int cfd = accept(lfd, NULL, NULL);
+        if (cfd < 0) continue;
+        serve_client(page, cfd);
+        close(cfd);
+    }
+}
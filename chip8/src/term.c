@@ -0,0 +1,183 @@
+// term.c
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "term.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Indexed by (bottom << 1) | top
+static const char *const glyphs[4] = {
+    " ",            // neither
+    "\xE2\x96\x80", // upper half block
+    "\xE2\x96\x84", // lower half block
+    "\xE2\x96\x88", // full block
+};
+
+static void term_write_all(const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(STDOUT_FILENO, p, len);
+        if (w <= 0) return;
+        p += w;
+        len -= (size_t)w;
+    }
+}
+
+static void term_append(Term *t, const char *s, size_t n) {
+    memcpy(t->buf + t->len, s, n);
+    t->len += n;
+}
+
+Term* term_init(void) {
+    Term *t = malloc(sizeof(Term));
+    if (!t) return NULL;
+    memset(t, 0, sizeof(*t));
+
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &t->saved) == 0) {
+        struct termios raw = t->saved;
+        raw.c_lflag &= ~(tcflag_t)(ICANON | ECHO | ISIG | IEXTEN);
+        raw.c_iflag &= ~(tcflag_t)(IXON | ICRNL);
+        raw.c_cc[VMIN] = 0;  // non-blocking reads
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0) t->raw = 1;
+    }
+
+    // Alternate screen, hide cursor, clear; a cleared screen matches the all-blank cells[]
+    static const char enter[] = "\033[?1049h\033[?25l\033[2J";
+    term_write_all(enter, sizeof(enter) - 1);
+    return t;
+}
+
+void term_render(Term *t, const uint8_t *gfx) {
+    int cur_row = -1, cur_col = -1; // where the terminal cursor is after the last glyph
+
+    for (int row = 0; row < TERM_ROWS; ++row) {
+        const uint8_t *top = &gfx[(row * 2) * DISPLAY_WIDTH];
+        const uint8_t *bottom = top + DISPLAY_WIDTH;
+        uint8_t *cells = &t->cells[row * TERM_COLS];
+
+        for (int col = 0; col < TERM_COLS; ++col) {
+            uint8_t cell = (uint8_t)(((bottom[col] & 1) << 1) | (top[col] & 1));
+            if (cells[col] == cell) continue;
+            cells[col] = cell;
+
+            if (row != cur_row || col != cur_col) {
+                char move[16];
+                int n = snprintf(move, sizeof(move), "\033[%d;%dH", row + 1, col + 1);
+                term_append(t, move, (size_t)n);
+            }
+            term_append(t, glyphs[cell], strlen(glyphs[cell]));
+            cur_row = row;
+            cur_col = col + 1;
+        }
+    }
+
+    if (t->len > 0) {
+        term_write_all(t->buf, t->len);
+        t->len = 0;
+    }
+}
+
+static int term_key_index(int ch) {
+    switch (ch) {
+        case '1': return 0x1;
+        case '2': return 0x2;
+        case '3': return 0x3;
+        case '4': return 0xC;
+        case 'q': return 0x4;
+        case 'w': return 0x5;
+        case 'e': return 0x6;
+        case 'r': return 0xD;
+        case 'a': return 0x7;
+        case 's': return 0x8;
+        case 'd': return 0x9;
+        case 'f': return 0xE;
+        case 'z': return 0xA;
+        case 'x': return 0x0;
+        case 'c': return 0xB;
+        case 'v': return 0xF;
+        default: return -1;
+    }
+}
+
+static uint64_t term_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Escape parser states
+enum { ESC_NONE, ESC_SEEN, ESC_CSI, ESC_SS3 };
+
+int term_handle_input(Term *t, Chip8 *c) {
+    uint64_t now = term_now_ns();
+
+    // Age out keys the terminal has stopped repeating
+    for (uint8_t k = 0; k < 16; ++k) {
+        if (t->key_release[k] && now >= t->key_release[k]) {
+            t->key_release[k] = 0;
+            chip8_set_key(c, k, 0);
+        }
+    }
+
+    if (!t->raw) return 1;
+
+    char in[64];
+    ssize_t n;
+    while ((n = read(STDIN_FILENO, in, sizeof(in))) > 0) {
+        for (ssize_t i = 0; i < n; ++i) {
+            unsigned char ch = (unsigned char)in[i];
+            if (ch == 0x03) return 0; // Ctrl-C
+
+            // Skip escape sequences (arrows etc.) so keys read around them still count:
+            // CSI is ESC [ params/intermediates final (0x40-0x7E), SS3 is ESC O x.
+            switch (t->esc) {
+            case ESC_SEEN:
+                if (ch == '[') { t->esc = ESC_CSI; continue; }
+                if (ch == 'O') { t->esc = ESC_SS3; continue; }
+                t->esc = ESC_NONE; // ESC + other byte: drop the ESC, handle the byte below
+                break;
+            case ESC_CSI:
+                if (ch >= 0x40 && ch <= 0x7E) t->esc = ESC_NONE;
+                continue;
+            case ESC_SS3:
+                t->esc = ESC_NONE;
+                continue;
+            }
+            if (ch == 0x1B) {
+                t->esc = ESC_SEEN;
+                t->esc_ns = now;
+                continue;
+            }
+
+            if (ch >= 'A' && ch <= 'Z') ch = (unsigned char)(ch - 'A' + 'a');
+            int key = term_key_index(ch);
+            if (key >= 0) {
+                // A press while still held is an auto-repeat
+                uint64_t hold_ms = t->key_release[key] ? TERM_KEY_REPEAT_HOLD_MS : TERM_KEY_FIRST_HOLD_MS;
+                chip8_set_key(c, (uint8_t)key, 1);
+                t->key_release[key] = now + hold_ms * 1000000ull;
+            }
+        }
+    }
+
+    // A lone ESC quits once nothing has followed it in time
+    if (t->esc == ESC_SEEN && now - t->esc_ns >= TERM_ESC_TIMEOUT_MS * 1000000ull) return 0;
+    return 1;
+}
+
+void term_set_beep(Term *t, int on) {
+    if (on && !t->beeping) term_write_all("\a", 1); // ring once per beep
+    t->beeping = on ? 1 : 0;
+}
+
+void term_cleanup(Term *t) {
+    if (!t) return;
+    static const char leave[] = "\033[0m\033[?25h\033[?1049l";
+    term_write_all(leave, sizeof(leave) - 1);
+    if (t->raw) tcsetattr(STDIN_FILENO, TCSAFLUSH, &t->saved);
+    free(t);
+}
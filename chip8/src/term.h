@@ -0,0 +1,52 @@
+// term.h
+
+/*
+Concepts:
+    Terminal backend for headless / SSH sessions, used instead of the SDL window with --term.
+    Two pixel rows are packed into one character cell with Unicode half blocks
+    (' ', upper half, lower half, full block), so the 64x32 display is 64x16 cells.
+    Each frame is diffed against the cells already on screen; only changed cells are written,
+    using cursor-addressing escapes, and the whole frame goes out in a single write().
+    Terminals only report key presses, never releases, so a pressed key is held for a while
+    and released unless the terminal's key repeat renews it. Auto-repeat starts only after a
+    delay (typically 250-500 ms), so the first press is held past that delay; once repeats
+    arrive they come every 30-100 ms and a much shorter hold is enough to bridge them, which
+    keeps the release prompt when the key is let go.
+    A bare ESC quits, but ESC also starts arrow/function key sequences whose bytes may land in
+    a later read(), so the parser state is kept across calls and a lone ESC only counts once
+    nothing follows it within a short timeout.
+*/
+
+#ifndef TERM_H
+#define TERM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <termios.h>
+#include "chip8.h"
+
+#define TERM_COLS DISPLAY_WIDTH
+#define TERM_ROWS (DISPLAY_HEIGHT / 2)
+#define TERM_KEY_FIRST_HOLD_MS 550  // longer than the usual auto-repeat delay
+#define TERM_KEY_REPEAT_HOLD_MS 150 // covers the gap between repeats
+#define TERM_ESC_TIMEOUT_MS 50      // a sequence's bytes arrive well within this
+
+typedef struct {
+    struct termios saved;        // terminal settings to restore on exit
+    int raw;                     // stdin was switched to raw mode
+    uint8_t cells[TERM_ROWS * TERM_COLS]; // what is on screen now
+    uint64_t key_release[16];    // monotonic ns at which a held key is released, 0 if up
+    uint8_t esc;                 // escape sequence parser state, kept across reads
+    uint64_t esc_ns;             // when a still-unfollowed ESC arrived
+    uint8_t beeping;             // bell already rung for the current beep
+    size_t len;
+    char buf[TERM_ROWS * TERM_COLS * 16];
+} Term;
+
+Term* term_init(void);
+void term_render(Term *t, const uint8_t *gfx);
+int term_handle_input(Term *t, Chip8 *c);
+void term_set_beep(Term *t, int on);
+void term_cleanup(Term *t);
+
+#endif